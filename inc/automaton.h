@@ -0,0 +1,43 @@
+#ifndef FIFTEEN_AUTOMATON_H
+#define FIFTEEN_AUTOMATON_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "puzzle.h"
+
+namespace Search
+{
+    // Recognises move sequences that lead to the same position as a shorter or equal but
+    // lexicographically smaller sequence, e.g. undoing a move or circling a 2x2 block.
+    // It is built by enumerating all sequences up to a given length on an unbounded board,
+    // a sequence only counting as redundant if its replacement stays within its bounding box,
+    // so the pruning holds on boards of any size. Searches follow one state per node and
+    // skip children whose move leads to DEAD.
+    class MoveAutomaton
+    {
+    public:
+        static const unsigned int START{0};
+        static const unsigned int DEAD;
+
+    private:
+        std::vector<std::array<unsigned int, 4>> transitions{};
+        std::size_t sequences{};
+
+        MoveAutomaton(unsigned int length);
+
+    public:
+        // Automaton for sequences up to length moves, built once and shared
+        static std::shared_ptr<const MoveAutomaton> get(unsigned int length);
+
+        unsigned int next(unsigned int state, Puzzle::Move move) const { return transitions[state][move]; }
+
+        std::size_t size() const;
+        // Number of redundant sequences recognised, not counting their extensions
+        std::size_t redundant() const;
+    };
+};
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef FIFTEEN_BATCH_H
+#define FIFTEEN_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "puzzle.h"
+#include "strings.h"
+
+// Binary files for batches of puzzles and their solutions. All integers are little endian.
+//
+// Instance file: 16 byte header ("FIFI", version, dimension, encoding, 0, count as u64)
+// followed by count fixed size records. PACKED records hold the tiles in row-major order,
+// 4 bits each on boards up to 4x4 and 8 bits each above; RANK records hold the lexicographic
+// rank of the tiles as a permutation in as few bytes as it needs, for boards up to 4x4.
+//
+// Solution file: 32 byte header ("FIFS", version, 0, 0, 0, count as u64, index position as u64,
+// 0 as u64), the moves of all solutions at 2 bits each, four to a byte starting from the low
+// bits, then an index of count + 1 u64 move offsets. Solution n is the moves between offsets
+// n and n + 1; the top bit of offset n is set if the puzzle was not solved.
+namespace Batch
+{
+    enum Encoding : unsigned char
+    {
+        PACKED,
+        RANK
+    };
+
+    class FormatException : public std::exception
+    {
+    public:
+        FormatException()
+            : std::exception(){};
+
+        const char *what() { return strings::EXCEPT_BATCH_FORMAT; }
+    };
+
+    // Read-only view of a whole file, memory mapped where the platform allows
+    class MappedFile
+    {
+    private:
+        const unsigned char *data{nullptr};
+        std::size_t length{0};
+        // Contents read into memory when the file can not be mapped
+        std::vector<unsigned char> buffer{};
+
+    public:
+        MappedFile(const std::string &path);
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        ~MappedFile();
+
+        const unsigned char *get() const { return data; }
+        std::size_t size() const { return length; }
+    };
+
+    // Size of an instance record in bytes
+    std::size_t recordSize(int dimension, Encoding encoding);
+
+    class InstanceReader
+    {
+    private:
+        MappedFile file;
+
+        int dimension{};
+        Encoding encoding{};
+        std::uint64_t count{};
+        std::size_t stride{};
+
+    public:
+        InstanceReader(const std::string &path);
+
+        int getDimension() const;
+        Encoding getEncoding() const;
+        std::uint64_t size() const;
+
+        // Load instance n into puzzle, which must have the file's dimension.
+        // Throws std::out_of_range past the last instance and FormatException for a bad record
+        void get(std::uint64_t n, Puzzle &puzzle) const;
+        Puzzle get(std::uint64_t n) const;
+    };
+
+    class SolutionReader
+    {
+    private:
+        MappedFile file;
+
+        std::uint64_t count{};
+        const unsigned char *moves{};
+        const unsigned char *index{};
+
+        std::uint64_t offset(std::uint64_t n) const;
+
+    public:
+        // Checks the whole offsets index, so no solution can reach outside the file
+        SolutionReader(const std::string &path);
+
+        std::uint64_t size() const;
+
+        // All throw std::out_of_range past the last solution
+        bool solved(std::uint64_t n) const;
+        std::uint64_t length(std::uint64_t n) const;
+        std::vector<Puzzle::Move> get(std::uint64_t n) const;
+    };
+
+    // Writers keep at most BUFFER_SIZE bytes in memory and fill in the header on close
+    class InstanceWriter
+    {
+    private:
+        static const std::size_t BUFFER_SIZE{1 << 16};
+
+        std::ofstream out;
+
+        const int dimension;
+        const Encoding encoding;
+        const std::size_t stride;
+        std::uint64_t count{0};
+
+        std::vector<unsigned char> buffer{};
+        std::vector<int> items{};
+
+        void flush();
+
+    public:
+        InstanceWriter(const std::string &path, int dimension, Encoding encoding = Encoding::PACKED);
+        InstanceWriter(const InstanceWriter &) = delete;
+        InstanceWriter &operator=(const InstanceWriter &) = delete;
+        ~InstanceWriter();
+
+        void write(const Puzzle &puzzle);
+        void close();
+    };
+
+    class SolutionWriter
+    {
+    private:
+        static const std::size_t BUFFER_SIZE{1 << 16};
+
+        const std::string path;
+        // The offsets index is spooled to a file of its own and appended on close
+        const std::string indexPath;
+
+        std::ofstream out;
+        std::ofstream indexOut;
+
+        std::uint64_t count{0};
+        std::uint64_t moves{0};
+
+        std::vector<unsigned char> buffer{};
+        std::vector<unsigned char> indexBuffer{};
+
+        void flush();
+        void add(std::uint64_t offset);
+
+    public:
+        SolutionWriter(const std::string &path);
+        SolutionWriter(const SolutionWriter &) = delete;
+        SolutionWriter &operator=(const SolutionWriter &) = delete;
+        ~SolutionWriter();
+
+        void write(const std::vector<Puzzle::Move> &solution);
+        // Record that the next puzzle has no solution
+        void writeUnsolved();
+        void close();
+    };
+};
+
+#endif
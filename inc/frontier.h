@@ -0,0 +1,128 @@
+#ifndef FIFTEEN_FRONTIER_H
+#define FIFTEEN_FRONTIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Breadth-first frontier search over a whole sliding-tile state space using external memory.
+//
+// Every layer is a file of sorted state ranks stored as varint-encoded deltas. Successors of a
+// layer are expanded by several threads into buffers bounded by the memory budget, which are
+// sorted and spilled to run files. The runs are then merged and duplicates removed by streaming
+// them against the previous two layers, in several passes when there are more runs than file
+// buffers fit in the budget, so memory use stays fixed while disk use grows with the widest layer.
+namespace Frontier
+{
+    // Bytes buffered by every layer file read or written
+    const std::size_t IO_BUFFER_SIZE{1 << 20};
+
+    // Board of rows x cols cells where the blank and the tiles of a pattern are tracked.
+    // A state is the sequence of cells holding the blank and each pattern tile, ranked as a partial permutation.
+    class Space
+    {
+    private:
+        int rows;
+        int cols;
+        std::vector<int> tiles;
+
+    public:
+        Space(int rows, int cols, std::vector<int> tiles);
+
+        int cells() const { return rows * cols; }
+        int items() const { return tiles.size() + 1; }
+        std::uint64_t size() const;
+
+        std::uint64_t goal() const;
+        // Append ranks of all states one move away. positions and occupant are scratch space.
+        void expand(std::uint64_t rank, std::vector<int> &positions, std::vector<int> &occupant, std::vector<std::uint64_t> &out) const;
+        std::string format(std::uint64_t rank) const;
+    };
+
+    class LayerWriter
+    {
+    private:
+        std::ofstream file;
+        std::vector<char> buffer{};
+        std::uint64_t last{0};
+        std::uint64_t count{0};
+
+        void flush();
+
+    public:
+        LayerWriter(const std::string &path);
+        ~LayerWriter();
+
+        // Ranks must be written in increasing order
+        void write(std::uint64_t rank);
+        std::uint64_t size() const { return count; }
+        void close();
+    };
+
+    class LayerReader
+    {
+    private:
+        std::ifstream file;
+        std::vector<char> buffer;
+        std::size_t position{0};
+        std::size_t length{0};
+        std::uint64_t last{0};
+
+        bool fill();
+
+    public:
+        LayerReader(const std::string &path);
+
+        bool read(std::uint64_t &rank);
+    };
+
+    class BreadthFirstSearch
+    {
+    public:
+        // Called with the size of every layer once it is complete
+        using Progress = std::function<void(unsigned int depth, std::uint64_t count)>;
+
+    private:
+        // States a worker expands between two visits to the shared layer reader
+        static const std::size_t BATCH_SIZE{1 << 14};
+
+        const Space &space;
+        const std::string dir;
+        const std::size_t threads;
+        // Successors a worker holds before spilling them, in what the budget leaves after the
+        // buffers of the layer read and the run written by every worker
+        const std::size_t bufferSize;
+        // Runs merged at once, their readers fit in the budget with those of the previous two
+        // layers and the writer of the merged run
+        const std::size_t fanIn;
+
+        std::mutex mutex{};
+        std::vector<std::string> runs{};
+
+        std::string layerPath(unsigned int depth) const;
+        std::string spill(std::vector<std::uint64_t> &buffer, unsigned int depth);
+        // Expand every state of a layer into sorted run files
+        void expand(unsigned int depth);
+        // Merge sorted runs into out, dropping duplicates and states found in any of the previous layers
+        void mergeRuns(const std::vector<std::string> &paths, LayerWriter &out, const std::vector<std::string> &previousPaths);
+        // Merge the runs into the next layer, dropping states already in the current or previous layer
+        std::uint64_t merge(unsigned int depth);
+
+    public:
+        // Layer and run files go to dir, memory is the budget in bytes
+        BreadthFirstSearch(const Space &space, const std::string &dir, std::size_t threads, std::size_t memory);
+
+        // Returns the number of states per distance from the goal
+        std::vector<std::uint64_t> run(bool keep, const Progress &progress = Progress{});
+        // Up to count states of the layer at depth, which must have been kept
+        std::vector<std::uint64_t> hardest(unsigned int depth, std::size_t count);
+        // Remove the last two layers, which run leaves behind
+        void cleanup(unsigned int depth);
+    };
+};
+
+#endif
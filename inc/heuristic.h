@@ -1,6 +1,9 @@
 #ifndef FIFTEEN_HEURISTIC_H
 #define FIFTEEN_HEURISTIC_H
 
+#include <memory>
+#include <vector>
+
 #include "puzzle.h"
 
 namespace Heuristic
@@ -9,18 +12,101 @@ namespace Heuristic
     {
     public:
         unsigned int operator()(const Puzzle &p) const;
+        unsigned int update(const Puzzle &p, unsigned int h, Puzzle::Move move) const;
+        bool labelGoals() const { return true; }
     };
 
+    // Manhattan distance plus two moves for every tile that must leave its row or column
+    // for the rest of the line to reach their goal order
     class LinearConflictHeuristic : public Puzzle::Heuristic
     {
     public:
         unsigned int operator()(const Puzzle &p) const;
+        bool labelGoals() const { return true; }
+    };
+
+    // Same values as LinearConflictHeuristic, but the conflicts of a line are looked up by a
+    // key of the goal positions of the tiles in it, from tables built once per dimension up
+    // to TABLE_MAX_DIMENSION and computed directly above that, and updated per move.
+    class LinearConflictTableHeuristic : public Puzzle::Heuristic
+    {
+    public:
+        static const int TABLE_MAX_DIMENSION{6};
+        // Lines are computed without allocating up to this dimension
+        static const int DIRECT_MAX_DIMENSION{16};
+
+    private:
+        static const std::vector<unsigned char> &table(int dimension);
+        // Conflicts of a row or column, reading the board with the cells at swapA and swapB
+        // exchanged (-1 for none) to see it as it was before a move
+        static unsigned int lineConflicts(const Puzzle &p, int line, bool column, int swapA, int swapB);
+
+    public:
+        unsigned int operator()(const Puzzle &p) const;
+        unsigned int update(const Puzzle &p, unsigned int h, Puzzle::Move move) const;
+        bool labelGoals() const { return true; }
     };
 
     class MisplacedTilesHeuristic : public Puzzle::Heuristic
     {
     public:
         unsigned int operator()(const Puzzle &p) const;
+        unsigned int update(const Puzzle &p, unsigned int h, Puzzle::Move move) const;
+        bool labelGoals() const { return true; }
+    };
+
+    // Max of the wrapped heuristic on the state, its reflection along the main diagonal
+    // and, when the blank is at its goal position, its dual (inverse permutation).
+    // Every search takes an instance of its own that follows the path searched, making and
+    // undoing each move on the reflection and the dual instead of building them again.
+    class ReflectionDualHeuristic : public Puzzle::Heuristic
+    {
+    private:
+        // Per search state, kept apart so that the shared instance is never written to
+        class Tracker : public Puzzle::Heuristic
+        {
+        private:
+            struct Entry
+            {
+                Puzzle::Move move;
+                unsigned int h;
+                unsigned int reflectedH;
+            };
+
+            std::shared_ptr<const Puzzle::Heuristic> heuristic;
+
+            // Last state evaluated and its reflection and dual, following each other move by move
+            mutable std::unique_ptr<Puzzle> board{};
+            mutable std::unique_ptr<Puzzle> reflected{};
+            mutable std::unique_ptr<Puzzle> dual{};
+            // Moves leading to board, with the wrapped heuristic values of each state
+            mutable std::vector<Entry> path{};
+
+            // Make move on the board, its reflection and its dual, false if it is not possible
+            bool follow(Puzzle::Move move) const;
+            unsigned int evaluate(const Entry &entry) const;
+
+        public:
+            Tracker(std::shared_ptr<const Puzzle::Heuristic> heuristic);
+
+            unsigned int operator()(const Puzzle &p) const;
+            unsigned int update(const Puzzle &p, unsigned int h, Puzzle::Move move) const;
+        };
+
+        std::shared_ptr<const Puzzle::Heuristic> heuristic;
+
+        static Puzzle::Move reflect(Puzzle::Move move);
+        static void reflect(const Puzzle &p, Puzzle &reflection);
+        // Dual of p, only a valid board while the blank of p is at its goal position
+        static void dualize(const Puzzle &p, Puzzle &dual);
+        // Keep dual that of p after p made move
+        static void dualize(const Puzzle &p, Puzzle::Move move, Puzzle &dual);
+
+    public:
+        ReflectionDualHeuristic(std::shared_ptr<const Puzzle::Heuristic> heuristic);
+
+        unsigned int operator()(const Puzzle &p) const;
+        std::unique_ptr<const Puzzle::Heuristic> forSearch() const;
     };
 };
 
@@ -0,0 +1,66 @@
+#ifndef FIFTEEN_OPTIMIZER_H
+#define FIFTEEN_OPTIMIZER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "puzzle.h"
+
+namespace Search
+{
+    // Shortens a path of moves from a start state, e.g. the solution of a weighted or
+    // constructive solver. Cycles back to an earlier state are cut out first, then the path is
+    // cut into windows whose segments are replaced by optimal ones between the same two states,
+    // found with IDA*. Windows are optimized in parallel, in passes alternating between two
+    // offsets so that inefficiencies across a window border are caught by the next pass,
+    // until a pass in each offset gains nothing or the time budget runs out.
+    class PathOptimizer
+    {
+    public:
+        struct Options
+        {
+            // Moves per window; larger windows find more but cost exponentially more to search
+            unsigned int window{24};
+            // Time for all passes, zero for no limit
+            std::chrono::milliseconds budget{1000};
+            // Windows searched at once, zero for one per hardware thread
+            unsigned int threads{0};
+        };
+
+        struct Result
+        {
+            std::vector<Puzzle::Move> moves{};
+            // Moves removed by cutting out cycles and by replacing windows
+            std::size_t cycleMoves{};
+            std::size_t windowMoves{};
+            unsigned int passes{};
+            unsigned long long nodes{};
+        };
+
+    private:
+        const std::shared_ptr<const Puzzle::Heuristic> heuristic;
+        const Options options;
+
+        // Optimal path from the first state to the second, at most maxLength moves long
+        std::vector<Puzzle::Move> connect(const Puzzle &from, const Puzzle &to, unsigned int maxLength,
+                                          std::chrono::steady_clock::time_point deadline, std::atomic<bool> &running,
+                                          Puzzle::Stats &stats) const;
+
+    public:
+        // Moves that fail on the board they are made on are dropped, they change nothing
+        static std::vector<Puzzle::Move> removeCycles(const Puzzle &start, const std::vector<Puzzle::Move> &moves);
+
+        // Windows only shrink to optimal paths if the heuristic is admissible. Unless it reads
+        // goals off labels, only windows ending with the blank in the last cell are searched.
+        PathOptimizer(std::shared_ptr<const Puzzle::Heuristic> heuristic);
+        PathOptimizer(std::shared_ptr<const Puzzle::Heuristic> heuristic, const Options &options);
+
+        // Returns what was found so far if running is cleared
+        Result run(const Puzzle &start, const std::vector<Puzzle::Move> &moves, std::atomic<bool> &running) const;
+    };
+};
+
+#endif
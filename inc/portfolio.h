@@ -0,0 +1,62 @@
+#ifndef FIFTEEN_PORTFOLIO_H
+#define FIFTEEN_PORTFOLIO_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "puzzle.h"
+
+namespace Search
+{
+    // Races several solver configurations on the same puzzle, one thread each.
+    // The first solution found is kept and the other searches are cancelled, so it is only
+    // optimal when every configuration is admissible, as the default ones are. Wins are
+    // counted across runs.
+    class PortfolioSearch
+    {
+    public:
+        struct Config
+        {
+            std::string name;
+            std::shared_ptr<const Puzzle::Heuristic> heuristic;
+            Puzzle::Options options{};
+        };
+
+        struct Result
+        {
+            std::vector<Puzzle::Move> moves{};
+            std::size_t winner{};
+            // Of the winning configuration, totalNodes also counts those of the cancelled ones
+            Puzzle::Stats stats{};
+            unsigned long long totalNodes{};
+            std::chrono::nanoseconds elapsed{};
+        };
+
+    private:
+        // How often the caller's running flag is checked while the race is on
+        static const std::chrono::milliseconds POLL_INTERVAL;
+
+        std::vector<Config> configs;
+        std::vector<unsigned int> wins;
+
+    public:
+        // Linear conflict and Manhattan distance, with both threshold policies and two move orders
+        static std::vector<Config> defaultConfigs();
+
+        PortfolioSearch(std::vector<Config> configs = defaultConfigs());
+
+        Result run(const Puzzle &puzzle, std::atomic<bool> &running);
+
+        // Drop all but the count configurations with the most wins
+        void prune(std::size_t count);
+
+        const std::vector<Config> &getConfigs() const;
+        const std::vector<unsigned int> &getWins() const;
+    };
+};
+
+#endif
@@ -1,10 +1,15 @@
 #ifndef FIFTEEN_PUZZLE_H
 #define FIFTEEN_PUZZLE_H
 
+#include <array>
+#include <cstdint>
 #include <vector>
-#include <deque>
 #include <atomic>
+#include <chrono>
 #include <exception>
+#include <functional>
+#include <memory>
+#include <string>
 
 #include "strings.h"
 
@@ -23,6 +28,16 @@ public:
     {
     public:
         virtual unsigned int operator()(const Puzzle &p) const = 0;
+        // Value of p reached by making move from a state valued h.
+        // Override when the heuristic can be updated cheaper than a full evaluation.
+        virtual unsigned int update(const Puzzle &p, unsigned int h, Move move) const { return (*this)(p); }
+        // Instance used by a single search, for heuristics that follow the path searched to
+        // update cheaper, so the shared one keeps no state. Others return nullptr and are shared.
+        virtual std::unique_ptr<const Heuristic> forSearch() const { return nullptr; }
+        // Whether the value only depends on how far each tile is from the cell its label names,
+        // so that it may value boards relabeled towards a goal with the blank elsewhere, which
+        // are no permutation. Heuristics that reorder the board rely on it being one.
+        virtual bool labelGoals() const { return false; }
         virtual ~Heuristic() = default;
     };
 
@@ -44,6 +59,15 @@ public:
         const char *what() { return strings::EXCEPT_MAX_THRESHOLD; }
     };
 
+    class DeadlineException : public std::exception
+    {
+    public:
+        DeadlineException()
+            : std::exception(){};
+
+        const char *what() { return strings::EXCEPT_DEADLINE; }
+    };
+
     class UnsolvableException : public std::exception
     {
     public:
@@ -53,15 +77,83 @@ public:
         const char *what() { return strings::EXCEPT_UNSOLVABLE_PUZZLE; }
     };
 
-private:
-    static unsigned int search(std::deque<Puzzle> &path, unsigned int moveCost, unsigned int threshold, const Heuristic &heuristic, std::atomic<bool> &running);
+    // Policy used to pick the threshold of the next IDA* iteration
+    enum Threshold
+    {
+        MINIMUM,   // Smallest f-value exceeding the current threshold
+        CONTROLLED // IDA*-CR: threshold chosen so node count roughly doubles per iteration
+    };
 
+    // Search algorithm used to find an optimal solution. Serial IDA* runs instead of the one
+    // asked for where it cannot be used, which Stats::engine tells.
+    enum Engine
+    {
+        IDA_STAR,
+        FRINGE, // Fringe search, keeps every state generated; boards above 4x4 use IDA* instead
+        // A* with duplicate detection, boards above 4x4 use IDA* instead and so does a search
+        // that reaches the memory limit
+        A_STAR,
+        // IDA* iterations at thresholds t, t + 2, t + 4, ... run side by side on separate threads.
+        // Weighted searches say nothing about solution length and run serially
+        PARALLEL_WINDOW
+    };
+
+    struct Options
+    {
+        Engine engine{Engine::IDA_STAR};
+        Threshold threshold{Threshold::MINIMUM};
+        // Deepest path the solver may explore, 0 for a bound derived from the dimension
+        unsigned int maxDepth{0};
+        // Weighted IDA* (f = g + weight * h); above 1 solutions are found faster but may not be optimal
+        unsigned int weight{1};
+        // Move sequences up to this length are checked for shorter or equal equivalents and pruned,
+        // 2 only rules out undoing the previous move, longer ones take exponentially longer to build
+        unsigned int pruneLength{10};
+        // Order in which the children of a node are tried, a permutation of all moves
+        std::array<Move, 4> order{Move::UP, Move::DOWN, Move::LEFT, Move::RIGHT};
+        // Give up with DeadlineException once this point in time is reached
+        std::chrono::steady_clock::time_point deadline{std::chrono::steady_clock::time_point::max()};
+        // Threads of the parallel window engine, 0 for one per hardware thread
+        unsigned int threads{0};
+        // Bytes the A* engine may hold before it gives up and runs IDA* instead
+        std::size_t memoryLimit{std::size_t{256} << 20};
+    };
+
+    struct Stats
+    {
+        unsigned long long nodes{0};
+        unsigned int iterations{0};
+        // Iterations plain IDA* would have run that controlled re-expansion skipped
+        unsigned int iterationsSaved{0};
+        // Most memory held at once by the states of an engine that keeps them, in bytes
+        std::size_t peakMemory{0};
+        // Engine that found the solution, IDA_STAR if the requested one fell back to it
+        Engine engine{Engine::IDA_STAR};
+    };
+
+    struct AnytimeResult
+    {
+        bool found{false};
+        std::vector<Move> moves{};
+        // Proven minimum length of any solution
+        unsigned int lowerBound{0};
+
+        bool optimal() const { return found && moves.size() == lowerBound; }
+    };
+
+private:
     int dimension;
     int *tiles;
 
     int blankRow;
     int blankCol;
 
+    // Zobrist hash: XOR of the keys of every tile at its cell, the blank having none
+    std::uint64_t hash;
+
+    static std::uint64_t zobrist(int index, int value);
+    void rehash();
+
     int &at(int row, int col);
 
 public:
@@ -78,21 +170,62 @@ public:
     int getDimension() const;
     int getSize() const;
 
+    // Letter of each move of the blank, U D L R, as solutions are written out
+    static const char MOVE_NAMES[4];
+
     bool move(Move move);
+    static Move inverse(Move move);
+    // Index the tile moved by the last move now occupies, i.e. the previous blank position
+    int movedTileIndex(Move move) const;
     std::vector<Move> validMoves() const;
     void shuffle();
 
-    int &get(int index) const;
-    int &get(int row, int col) const;
+    int getBlank() const;
+
+    int get(int index) const;
+    int get(int row, int col) const;
+    // Write a single cell without moving the tile it held elsewhere, leaving it to the caller
+    // to make the board a permutation again, e.g. when relabeling every tile
+    void put(int index, int value);
+    void put(int row, int col, int value);
     bool set(int index, int value);
     bool set(int row, int col, int value);
+    // Replace the whole board by tiles in row-major order, 0 for the blank.
+    // Returns false unless they are a permutation of 0..n-1 for a square board of n cells.
+    bool setTiles(const std::vector<int> &tiles);
+    // Same for the tiles written out separated by whitespace, e.g. a line of a puzzle file
+    bool parseTiles(const std::string &line);
+
+    // Boards up to PACK_MAX_DIMENSION fit 4 bits per tile into 64 bits, cell n in bits 4n..4n+3
+    static const int PACK_MAX_DIMENSION{4};
+    std::uint64_t pack() const;
+    void unpack(std::uint64_t packed);
 
     unsigned int inversionCount() const;
 
+    // Kept up to date by every change of the board, equal boards have equal hashes
+    std::uint64_t getHash() const;
+
     bool isSolved() const;
     bool isSolvable() const;
+    std::vector<Move> solveMoves(const Heuristic &heuristic, std::atomic<bool> &running, const Options &options, Stats &stats) const;
+    std::vector<Puzzle> solve(const Heuristic &heuristic, std::atomic<bool> &running, const Options &options, Stats &stats) const;
     std::vector<Puzzle> solve(const Heuristic &heuristic, std::atomic<bool> &running) const;
     std::vector<Puzzle> solve(const Heuristic &heuristic) const;
+    AnytimeResult solveAnytime(const Heuristic &heuristic, std::atomic<bool> &running, const Options &options, Stats &stats) const;
+    std::vector<Puzzle> trace(const std::vector<Move> &moves) const;
 };
 
+namespace std
+{
+    template <>
+    struct hash<Puzzle>
+    {
+        std::size_t operator()(const Puzzle &p) const noexcept
+        {
+            return p.getHash();
+        }
+    };
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,16 @@
+#ifndef FIFTEEN_RANK_H
+#define FIFTEEN_RANK_H
+
+#include <cstdint>
+
+namespace Rank
+{
+    // Number of sequences of count distinct values taken from 0..n-1, i.e. n! / (n - count)!
+    std::uint64_t size(int count, int n);
+
+    // Lexicographic rank of a sequence of count distinct values taken from 0..n-1 (n <= 64)
+    std::uint64_t rank(const int *items, int count, int n);
+    void unrank(std::uint64_t rank, int *items, int count, int n);
+};
+
+#endif
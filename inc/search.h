@@ -0,0 +1,318 @@
+#ifndef FIFTEEN_SEARCH_H
+#define FIFTEEN_SEARCH_H
+
+#include <array>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#include "automaton.h"
+#include "puzzle.h"
+#include "strings.h"
+
+namespace Search
+{
+    class CheckpointException : public std::exception
+    {
+    public:
+        CheckpointException()
+            : std::exception(){};
+
+        const char *what() { return strings::EXCEPT_CHECKPOINT; }
+    };
+
+    // IDA* driven by an explicit stack of frames instead of recursion.
+    // Frames are allocated once for the maximum depth, so a search does not allocate per node
+    // and its memory use does not depend on how deep the solution is.
+    // All progress lives in members, so a search can be suspended, saved, loaded and resumed.
+    class IDAStarSearch
+    {
+    public:
+        static unsigned int defaultMaxDepth(int dimension);
+
+    private:
+        static const unsigned int HISTOGRAM_SIZE{64};
+        static const unsigned char NO_MOVE{4};
+        // Nodes between two checks for cancellation and the deadline
+        static const unsigned long long CHECK_INTERVAL{256};
+
+        enum Phase
+        {
+            STARTING,
+            ITERATING,
+            BOUNDING, // Final branch and bound pass
+            FINISHED
+        };
+
+        struct Frame
+        {
+            unsigned char move;     // Move that led to this node
+            unsigned char nextMove; // Next child move to try
+            unsigned int g;
+            unsigned int h;
+            unsigned int state; // Of the move automaton
+        };
+
+        // Instance of the heuristic for this search alone, if it keeps state
+        const std::unique_ptr<const Puzzle::Heuristic> own;
+        const Puzzle::Heuristic &heuristic;
+        const Puzzle::Options options;
+        const std::shared_ptr<const MoveAutomaton> automaton;
+
+        const Puzzle start;
+        Puzzle board;
+
+        std::vector<Frame> frames;
+        std::vector<Puzzle::Move> best{};
+
+        Phase phase{Phase::STARTING};
+        unsigned int threshold{};
+        // No solution is shorter than this; raised after every failed iteration
+        unsigned int lowerBound{};
+        // Only solutions shorter than this are looked for
+        unsigned int bound{};
+
+        // State of the iteration in progress
+        bool active{false};
+        unsigned int depth{};
+        unsigned int min{};
+        unsigned long long nodes{};
+        // Count of f-values that exceeded the threshold, indexed by f - threshold - 1
+        std::array<unsigned long long, HISTOGRAM_SIZE> histogram{};
+
+        // Branch and bound pass: keep searching after a goal is found, tightening the threshold
+        bool bounded{false};
+
+        // Nodes left and point in time before a step pauses the search
+        unsigned long long budget{~0ull};
+        std::chrono::steady_clock::time_point pause{std::chrono::steady_clock::time_point::max()};
+
+        bool search(std::atomic<bool> &running, unsigned int &result);
+        unsigned int controlledThreshold(unsigned int minimum, unsigned int &saved) const;
+        void record(unsigned int depth);
+
+    public:
+        IDAStarSearch(const Puzzle &start, const Puzzle::Heuristic &heuristic, const Puzzle::Options &options);
+
+        unsigned int getMaxDepth() const;
+        // Only look for solutions shorter than bound
+        void setBound(unsigned int bound);
+
+        std::vector<Puzzle::Move> run(std::atomic<bool> &running, Puzzle::Stats &stats);
+        // Search until an optimal solution is found or running is cleared.
+        // Returns false when suspended, calling it again continues where it stopped.
+        bool resume(std::atomic<bool> &running, Puzzle::Stats &stats);
+        // Same as resume, but also pauses after about budget nodes or once until is reached
+        bool step(std::atomic<bool> &running, Puzzle::Stats &stats, unsigned long long budget,
+                  std::chrono::steady_clock::time_point until = std::chrono::steady_clock::time_point::max());
+        // Single iteration at threshold, returns 0 if a solution was found
+        // or the smallest f-value exceeding the threshold otherwise
+        unsigned int iterate(unsigned int threshold, std::atomic<bool> &running, Puzzle::Stats &stats);
+        const std::vector<Puzzle::Move> &solution() const;
+
+        // Threshold of the iteration in progress or the last one run
+        unsigned int getThreshold() const;
+        // Nodes of the iteration in progress, which stats only count once it is done
+        unsigned long long getNodes() const;
+
+        // Progress of a suspended search, to be loaded into a search of the same puzzle and heuristic
+        void save(std::ostream &out) const;
+        void load(std::istream &in);
+    };
+
+    // Parallel window IDA*: every thread runs a whole iteration at its own threshold, taking the
+    // next one up once done. Solution lengths all have the parity of the blank's distance to its
+    // goal cell, so thresholds of the other parity are skipped. A goal found at some threshold
+    // stops the iterations above it, but is only returned once every threshold below has failed,
+    // which proves it optimal. Failed iterations raise the lower bound past thresholds in between.
+    class ParallelWindowSearch
+    {
+    private:
+        // How often the caller's running flag is checked while the workers search
+        static const std::chrono::milliseconds POLL_INTERVAL;
+
+        struct Worker
+        {
+            std::atomic<bool> running{false};
+            bool searching{false};
+            unsigned int threshold{};
+        };
+
+        const Puzzle::Heuristic &heuristic;
+        const Puzzle::Options options;
+
+        const Puzzle start;
+        // Of every solution length
+        unsigned int parity;
+
+        // Everything below is guarded by mutex
+        std::mutex mutex{};
+        std::condition_variable done{};
+        std::vector<Worker> workers;
+        // Workers that have not run out of thresholds yet
+        unsigned int remaining{};
+
+        // Lowest threshold no worker has taken yet
+        unsigned int next{};
+        // No solution is shorter than this
+        unsigned int lowerBound{};
+        std::vector<Puzzle::Move> best{};
+        bool found{false};
+        // Set when cancelled or a worker failed, no more iterations are started
+        bool stopped{false};
+        std::exception_ptr error{};
+
+        // Rounds up to the parity of solution lengths
+        unsigned int parityCeil(unsigned int threshold) const;
+        // Stops the iterations below the lower bound and those that cannot beat the best solution
+        void cancelStale();
+        void work(Worker &worker, Puzzle::Stats &stats);
+
+    public:
+        ParallelWindowSearch(const Puzzle &start, const Puzzle::Heuristic &heuristic, const Puzzle::Options &options);
+
+        std::vector<Puzzle::Move> run(std::atomic<bool> &running, Puzzle::Stats &stats);
+    };
+
+    // Fringe search: thresholds as in IDA*, but the frontier of each iteration is kept in a list
+    // that the next one resumes from, and every generated state is cached with its best g-value.
+    // No iteration repeats the work of an earlier one and duplicates are caught at any depth,
+    // at the cost of memory growing with the states generated. Boards up to 4x4 only.
+    class FringeSearch
+    {
+    private:
+        static const unsigned long long CHECK_INTERVAL{256};
+        static const unsigned int NONE;
+
+        struct Node
+        {
+            std::uint64_t state; // Packed board
+            unsigned int g;
+            unsigned int h;
+            // Indices into nodes
+            unsigned int parent;
+            unsigned int prev;
+            unsigned int next;
+            Puzzle::Move move; // Move that led here from parent
+            bool listed;       // In the fringe list
+        };
+
+        // Instance of the heuristic for this search alone, if it keeps state
+        const std::unique_ptr<const Puzzle::Heuristic> own;
+        const Puzzle::Heuristic &heuristic;
+        const Puzzle::Options options;
+
+        const Puzzle start;
+
+        // Every state generated, nodes[0] being the head of the circular fringe list
+        std::vector<Node> nodes{};
+        // Open addressing table of node indices by state, at most half full
+        std::vector<unsigned int> table{};
+
+        unsigned int &slot(std::uint64_t state);
+        std::size_t footprint() const;
+        unsigned int find(std::uint64_t state);
+        unsigned int insert(std::uint64_t state);
+
+        void link(unsigned int node, unsigned int after);
+        void unlink(unsigned int node);
+
+    public:
+        FringeSearch(const Puzzle &start, const Puzzle::Heuristic &heuristic, const Puzzle::Options &options);
+
+        std::vector<Puzzle::Move> run(std::atomic<bool> &running, Puzzle::Stats &stats);
+    };
+
+    // A* with duplicate detection for boards up to 4x4, where the states fit in memory. Nodes live
+    // in an arena of fixed blocks and are found by packed state through an open addressing table.
+    // The open list is an array of buckets by f and then g, popping the deepest node of the lowest
+    // f in constant time. Once the nodes would take more than Options::memoryLimit bytes, they
+    // are all released and the puzzle is solved with IDA* instead.
+    class AStarSearch
+    {
+    private:
+        static const unsigned long long CHECK_INTERVAL{256};
+        static const unsigned int NONE;
+        // Nodes per arena block
+        static const std::size_t BLOCK_SIZE{1 << 16};
+
+        struct Node
+        {
+            std::uint64_t state; // Packed board
+            // Indices of nodes
+            unsigned int parent;
+            unsigned int next; // In the same bucket
+            unsigned short g;
+            unsigned short h;
+            unsigned char move; // Move that led here from parent
+            bool closed;
+            // Replaced by a node of the same state reached on a shorter path
+            bool stale;
+        };
+
+        // Instance of the heuristic for this search alone, if it keeps state
+        const std::unique_ptr<const Puzzle::Heuristic> own;
+        const Puzzle::Heuristic &heuristic;
+        const Puzzle::Options options;
+
+        const Puzzle start;
+
+        std::vector<std::unique_ptr<Node[]>> blocks{};
+        unsigned int count{};
+        // Open addressing table of node indices by state, at most half full
+        std::vector<unsigned int> table{};
+        // Heads of the lists of open nodes, indexed by f and then g
+        std::vector<std::vector<unsigned int>> buckets{};
+        // No open node has a lower f
+        unsigned int minF{};
+
+        Node &node(unsigned int index);
+        unsigned int &slot(std::uint64_t state);
+        std::size_t footprint() const;
+
+        // Both return false if the memory limit would be exceeded
+        bool reserve(Puzzle::Stats &stats);
+        bool allocate(unsigned int &index, Puzzle::Stats &stats);
+
+        void push(unsigned int index);
+        // Open node of the lowest f and highest g, NONE if there is none
+        unsigned int pop();
+
+        // False if it ran out of memory
+        bool search(std::atomic<bool> &running, Puzzle::Stats &stats, std::vector<Puzzle::Move> &moves);
+
+    public:
+        AStarSearch(const Puzzle &start, const Puzzle::Heuristic &heuristic, const Puzzle::Options &options);
+
+        std::vector<Puzzle::Move> run(std::atomic<bool> &running, Puzzle::Stats &stats);
+    };
+
+    // Returns a first, possibly suboptimal, solution quickly using weighted IDA*, then improves it
+    // with decreasing weights while admissible IDA* iterations raise the proven lower bound.
+    // Stops when both meet or the deadline is reached and returns the best solution found so far.
+    class AnytimeSearch
+    {
+    private:
+        static const std::array<unsigned int, 3> WEIGHTS;
+
+        const Puzzle::Heuristic &heuristic;
+        const Puzzle::Options options;
+
+        const Puzzle start;
+
+        void improve(Puzzle::AnytimeResult &result, unsigned int weight, std::atomic<bool> &running, Puzzle::Stats &stats);
+
+    public:
+        AnytimeSearch(const Puzzle &start, const Puzzle::Heuristic &heuristic, const Puzzle::Options &options);
+
+        Puzzle::AnytimeResult run(std::atomic<bool> &running, Puzzle::Stats &stats);
+    };
+};
+
+#endif
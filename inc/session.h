@@ -0,0 +1,94 @@
+#ifndef FIFTEEN_SESSION_H
+#define FIFTEEN_SESSION_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "puzzle.h"
+#include "search.h"
+
+// Solves a copy of a puzzle on a worker thread of its own.
+// The search can be suspended and resumed any number of times and checkpointed to a file,
+// from which a later session, possibly in another process, goes on where it stopped.
+class SolverSession
+{
+public:
+    enum State
+    {
+        IDLE,
+        RUNNING,
+        SUSPENDED,
+        SOLVED,
+        CANCELLED,
+        UNSOLVABLE,
+        FAILED
+    };
+
+    // Called on the worker thread whenever it stops, whatever the reason. It may start the
+    // session again, which the same worker then runs.
+    using Callback = std::function<void(SolverSession &session)>;
+
+private:
+    static const char CHECKPOINT_HEADER[];
+
+    const Puzzle puzzle;
+    const std::shared_ptr<const Puzzle::Heuristic> heuristic;
+    const Puzzle::Options options;
+
+    Search::IDAStarSearch search;
+
+    std::thread thread{};
+    std::atomic<bool> running{false};
+    std::atomic<bool> cancelled{false};
+    std::atomic<State> state{State::IDLE};
+
+    // Only touched by the worker while it runs
+    Puzzle::Stats stats{};
+    std::chrono::nanoseconds elapsed{};
+    // Set when the callback starts the session again
+    bool restarted{false};
+
+    Callback callback{};
+
+    void work();
+
+public:
+    SolverSession(const Puzzle &puzzle, std::shared_ptr<const Puzzle::Heuristic> heuristic, const Puzzle::Options &options = Puzzle::Options{});
+    SolverSession(const SolverSession &) = delete;
+    SolverSession &operator=(const SolverSession &) = delete;
+
+    // Cancels the search and waits for the worker
+    ~SolverSession();
+
+    void setCallback(Callback callback);
+
+    // Starts the search, or resumes it if suspended. Returns false if there is nothing to run.
+    bool start();
+    // Stops the search so that it can be resumed and waits for the worker
+    void suspend();
+    // Stops the search for good and waits for the worker
+    void cancel();
+    // Waits for the worker to stop on its own
+    void wait();
+
+    // Writes the progress to path, suspending the search meanwhile if it is running.
+    // The heuristic is not saved and must be passed again to restore.
+    void checkpoint(const std::string &path);
+    // Suspended session continuing the search saved to path. The deadline is not restored.
+    static std::unique_ptr<SolverSession> restore(const std::string &path, std::shared_ptr<const Puzzle::Heuristic> heuristic);
+
+    State getState() const;
+    const Puzzle &getPuzzle() const;
+
+    // Only meaningful while the worker is stopped
+    const std::vector<Puzzle::Move> &getSolution() const;
+    const Puzzle::Stats &getStats() const;
+    std::chrono::nanoseconds getElapsed() const;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef FIFTEEN_STREAM_H
+#define FIFTEEN_STREAM_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "puzzle.h"
+#include "search.h"
+
+// Solves a copy of a puzzle on the caller's thread, a slice at a time as events are pulled.
+// Every call to next() searches at most about one slice of nodes, and for no longer than about
+// the slice time, before returning progress, then the moves of the solution are returned one by one. Streams never throw while searching,
+// many of them can be interleaved on one thread and dropping one stops its search.
+class SolverStream
+{
+public:
+    static const unsigned long long DEFAULT_SLICE{1 << 16};
+    // Short enough for a slice to run between the events of a GUI without being noticed
+    static const std::chrono::milliseconds DEFAULT_SLICE_TIME;
+
+    struct Event
+    {
+        enum Type
+        {
+            ITERATION, // An iteration at a new threshold started during the slice
+            PROGRESS,  // A slice was searched
+            MOVE,      // Next move of the solution
+            SOLVED,    // All moves were returned
+            UNSOLVABLE,
+            FAILED // Deadline or maximum threshold reached
+        };
+
+        Type type{};
+        unsigned int threshold{};
+        // Expanded so far, over all iterations
+        unsigned long long nodes{};
+        Puzzle::Move move{};
+    };
+
+private:
+    enum State
+    {
+        SEARCHING,
+        MOVES,
+        FINISHED
+    };
+
+    const Puzzle puzzle;
+    const std::shared_ptr<const Puzzle::Heuristic> heuristic;
+    const unsigned long long slice;
+    const std::chrono::nanoseconds sliceTime;
+
+    Search::IDAStarSearch search;
+
+    State state{State::SEARCHING};
+    std::atomic<bool> running{true};
+    Puzzle::Stats stats{};
+    std::chrono::nanoseconds elapsed{};
+
+    // Last threshold returned with an ITERATION event, 0 before the first
+    unsigned int threshold{};
+    // Moves returned so far
+    std::size_t step{};
+
+public:
+    SolverStream(const Puzzle &puzzle, std::shared_ptr<const Puzzle::Heuristic> heuristic, const Puzzle::Options &options = Puzzle::Options{},
+                 unsigned long long slice = DEFAULT_SLICE, std::chrono::nanoseconds sliceTime = DEFAULT_SLICE_TIME);
+    SolverStream(const SolverStream &) = delete;
+    SolverStream &operator=(const SolverStream &) = delete;
+
+    // Next event, false once SOLVED, UNSOLVABLE or FAILED has been returned
+    bool next(Event &event);
+    bool finished() const;
+
+    const Puzzle &getPuzzle() const;
+    const Puzzle::Stats &getStats() const;
+    // Time spent searching, excluding the time between calls
+    std::chrono::nanoseconds getElapsed() const;
+};
+
+#endif
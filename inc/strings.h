@@ -4,9 +4,12 @@
 namespace strings
 {
     inline constexpr char ALERT_HELP[] = "Move the blank tile using W A S D keys or edit a tile directly by clicking on that tile\n"
-                                         "Press the \"Shuffle\" button to randomize the puzzle\n\n"
+                                         "Press the \"Shuffle\" button to randomize the puzzle\n"
+                                         "Change the board dimension with the \"Size\" spinner\n\n"
                                          "Press the \"Solve\" button to solve the current puzzle using IDA* with selected heuristic\n"
-                                         "- Use Linear Conflict heuristic for faster results";
+                                         "- Use Linear Conflict heuristic for faster results\n"
+                                         "- Boards up to 4x4 are solved in the background while you play\n"
+                                         "- Press \"Play\" to step through the solution automatically at the chosen rate";
     inline constexpr char ALERT_ALREADY_SOLVED[] = "Puzzle already solved";
     inline constexpr char ALERT_UNSOLVABLE_PUZZLE[] = "Puzzle unsolvable";
     inline constexpr char ALERT_SOLVE_FAILED[] = "Failed to solve puzzle";
@@ -19,10 +22,17 @@ namespace strings
     inline constexpr char BUTTON_ABORT[] = "Abort";
     inline constexpr char BUTTON_RETURN[] = "Return";
     inline constexpr char BUTTON_STEP[] = "Step ";
+    inline constexpr char BUTTON_PLAY[] = "Play";
+    inline constexpr char BUTTON_PAUSE[] = "Pause";
+
+    inline constexpr char LABEL_THRESHOLD[] = "f<=";
 
     inline constexpr char EXCEPT_CANCELLED[] = "Cancelled by user";
     inline constexpr char EXCEPT_MAX_THRESHOLD[] = "Max threshold reached";
+    inline constexpr char EXCEPT_DEADLINE[] = "Deadline reached";
     inline constexpr char EXCEPT_UNSOLVABLE_PUZZLE[] = "Unsolvable puzzle";
+    inline constexpr char EXCEPT_CHECKPOINT[] = "Invalid or unreadable checkpoint";
+    inline constexpr char EXCEPT_BATCH_FORMAT[] = "Invalid or unreadable batch file";
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,271 @@
+#include "automaton.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    // Sequences are packed two bits per move, the first move in the highest bits
+    const unsigned int MAX_LENGTH{24};
+
+    const int ROW_DELTA[]{-1, 1, 0, 0};
+    const int COL_DELTA[]{0, 0, -1, 1};
+
+    struct Box
+    {
+        int minRow, maxRow, minCol, maxCol;
+
+        bool within(const Box &b) const
+        {
+            return minRow >= b.minRow && maxRow <= b.maxRow && minCol >= b.minCol && maxCol <= b.maxCol;
+        }
+    };
+
+    std::uint64_t key(std::uint64_t code, unsigned int length)
+    {
+        return (std::uint64_t{length} << 56) | code;
+    }
+
+    // Sequence kept so far, with its bounding box relative to where the blank started
+    struct Entry
+    {
+        std::uint64_t code;
+        unsigned int length;
+        Box box;
+    };
+
+    // Applies the sequence to a board large enough to never reach its edge, with the blank
+    // starting at the centre and every cell holding its own index. Fills effect with the cells
+    // that changed and their new contents, which identifies what the sequence did, and
+    // returns a hash of it.
+    std::uint64_t simulate(std::uint64_t code, unsigned int length, std::vector<int> &board, std::vector<int> &effect, Box &box)
+    {
+        const int size{2 * MAX_LENGTH + 1};
+
+        int row{MAX_LENGTH}, col{MAX_LENGTH};
+        box = Box{0, 0, 0, 0};
+
+        std::vector<int> visited{row * size + col};
+        for (unsigned int n{0}; n < length; n++)
+        {
+            int move = (code >> (2 * (length - 1 - n))) & 3;
+            int next{(row + ROW_DELTA[move]) * size + col + COL_DELTA[move]};
+
+            std::swap(board[row * size + col], board[next]);
+            row += ROW_DELTA[move];
+            col += COL_DELTA[move];
+            visited.push_back(next);
+
+            box.minRow = std::min(box.minRow, row - static_cast<int>(MAX_LENGTH));
+            box.maxRow = std::max(box.maxRow, row - static_cast<int>(MAX_LENGTH));
+            box.minCol = std::min(box.minCol, col - static_cast<int>(MAX_LENGTH));
+            box.maxCol = std::max(box.maxCol, col - static_cast<int>(MAX_LENGTH));
+        }
+
+        std::sort(visited.begin(), visited.end());
+        visited.erase(std::unique(visited.begin(), visited.end()), visited.end());
+
+        // FNV-1a over the changed cells
+        std::uint64_t hash{14695981039346656037ull};
+        effect.clear();
+        for (int cell : visited)
+        {
+            if (board[cell] != cell)
+            {
+                effect.push_back(cell);
+                effect.push_back(board[cell]);
+
+                hash = (hash ^ static_cast<std::uint64_t>(cell)) * 1099511628211ull;
+                hash = (hash ^ static_cast<std::uint64_t>(board[cell])) * 1099511628211ull;
+            }
+
+            // Leave the board as it was for the next sequence
+            board[cell] = cell;
+        }
+
+        return hash;
+    }
+}
+
+const unsigned int Search::MoveAutomaton::START;
+const unsigned int Search::MoveAutomaton::DEAD{~0u};
+
+std::shared_ptr<const Search::MoveAutomaton> Search::MoveAutomaton::get(unsigned int length)
+{
+    static std::mutex mutex{};
+    static std::map<unsigned int, std::shared_ptr<const MoveAutomaton>> built{};
+
+    length = std::min(length, MAX_LENGTH);
+
+    std::lock_guard<std::mutex> lock{mutex};
+
+    std::shared_ptr<const MoveAutomaton> &automaton{built[length]};
+    if (!automaton)
+        automaton = std::shared_ptr<const MoveAutomaton>(new MoveAutomaton(length));
+
+    return automaton;
+}
+
+Search::MoveAutomaton::MoveAutomaton(unsigned int length)
+{
+    const int size{2 * MAX_LENGTH + 1};
+    std::vector<int> board(size * size);
+    for (int n{0}; n < size * size; n++)
+        board[n] = n;
+
+    // Sequences kept so far, by the hash of what they do
+    std::unordered_map<std::uint64_t, std::vector<Entry>> effects{};
+
+    std::vector<int> effect{}, other{};
+    Box box{}, otherBox{};
+
+    effects[simulate(0, 0, board, effect, box)].push_back(Entry{0, 0, box});
+
+    // Sequences are visited by length, then lexicographically. A sequence is redundant if one
+    // visited earlier does the same within its bounding box; those containing a redundant
+    // sequence are not extended, which leaves the shortest redundant ones.
+    std::unordered_set<std::uint64_t> redundantKeys{};
+    std::vector<std::pair<std::uint64_t, unsigned int>> redundantSequences{};
+
+    std::vector<std::uint64_t> level{0};
+    for (unsigned int l{1}; l <= length; l++)
+    {
+        std::vector<std::uint64_t> nextLevel{};
+
+        for (std::uint64_t prefix : level)
+        {
+            for (std::uint64_t move{0}; move < 4; move++)
+            {
+                std::uint64_t code{(prefix << 2) | move};
+
+                bool contains{false};
+                for (unsigned int k{2}; k < l && !contains; k++)
+                    contains = redundantKeys.count(key(code & ((std::uint64_t{1} << (2 * k)) - 1), k)) > 0;
+                if (contains)
+                    continue;
+
+                std::vector<Entry> &entries{effects[simulate(code, l, board, effect, box)]};
+
+                // Hashes may collide, compare what the sequences actually do
+                bool redundant{false};
+                for (const Entry &entry : entries)
+                {
+                    if (!entry.box.within(box))
+                        continue;
+
+                    simulate(entry.code, entry.length, board, other, otherBox);
+                    if (other == effect)
+                    {
+                        redundant = true;
+                        break;
+                    }
+                }
+
+                if (redundant)
+                {
+                    redundantKeys.insert(key(code, l));
+                    redundantSequences.emplace_back(code, l);
+                    continue;
+                }
+
+                entries.push_back(Entry{code, l, box});
+                nextLevel.push_back(code);
+            }
+        }
+
+        level = std::move(nextLevel);
+    }
+
+    sequences = redundantSequences.size();
+
+    // Aho-Corasick automaton over the redundant sequences: a trie whose missing edges
+    // are filled in from the longest suffix that is also in the trie
+    std::vector<std::array<unsigned int, 4>> trie(1, {DEAD, DEAD, DEAD, DEAD});
+    std::vector<bool> dead(1, false);
+
+    for (const auto &[code, l] : redundantSequences)
+    {
+        unsigned int state{START};
+        for (unsigned int n{0}; n < l; n++)
+        {
+            int move = (code >> (2 * (l - 1 - n))) & 3;
+            if (trie[state][move] == DEAD)
+            {
+                trie[state][move] = trie.size();
+                trie.push_back({DEAD, DEAD, DEAD, DEAD});
+                dead.push_back(false);
+            }
+            state = trie[state][move];
+        }
+        dead[state] = true;
+    }
+
+    std::vector<unsigned int> fail(trie.size(), START);
+    std::queue<unsigned int> queue{};
+
+    for (int move{0}; move < 4; move++)
+    {
+        unsigned int &child{trie[START][move]};
+        if (child == DEAD)
+            child = START;
+        else
+            queue.push(child);
+    }
+
+    while (!queue.empty())
+    {
+        unsigned int state{queue.front()};
+        queue.pop();
+
+        // Ending in a redundant sequence is as bad as being one
+        dead[state] = dead[state] || dead[fail[state]];
+
+        for (int move{0}; move < 4; move++)
+        {
+            unsigned int &child{trie[state][move]};
+            if (child == DEAD)
+            {
+                child = trie[fail[state]][move];
+            }
+            else
+            {
+                fail[child] = trie[fail[state]][move];
+                queue.push(child);
+            }
+        }
+    }
+
+    // Only keep the states a search can be in
+    std::vector<unsigned int> index(trie.size(), DEAD);
+    unsigned int live{0};
+    for (unsigned int state{0}; state < trie.size(); state++)
+    {
+        if (!dead[state])
+            index[state] = live++;
+    }
+
+    transitions.resize(live);
+    for (unsigned int state{0}; state < trie.size(); state++)
+    {
+        if (dead[state])
+            continue;
+
+        for (int move{0}; move < 4; move++)
+            transitions[index[state]][move] = index[trie[state][move]];
+    }
+}
+
+std::size_t Search::MoveAutomaton::size() const
+{
+    return transitions.size();
+}
+
+std::size_t Search::MoveAutomaton::redundant() const
+{
+    return sequences;
+}
@@ -0,0 +1,471 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "rank.h"
+
+namespace
+{
+    const char INSTANCE_MAGIC[]{'F', 'I', 'F', 'I'};
+    const char SOLUTION_MAGIC[]{'F', 'I', 'F', 'S'};
+    const unsigned char VERSION{1};
+
+    const std::size_t INSTANCE_HEADER_SIZE{16};
+    const std::size_t SOLUTION_HEADER_SIZE{32};
+
+    const std::uint64_t UNSOLVED{std::uint64_t{1} << 63};
+
+    void putLE(std::vector<unsigned char> &out, std::uint64_t value, std::size_t bytes)
+    {
+        for (std::size_t n{0}; n < bytes; n++)
+            out.push_back(static_cast<unsigned char>(value >> (8 * n)));
+    }
+
+    std::uint64_t getLE(const unsigned char *in, std::size_t bytes)
+    {
+        std::uint64_t value{0};
+        for (std::size_t n{0}; n < bytes; n++)
+            value |= static_cast<std::uint64_t>(in[n]) << (8 * n);
+
+        return value;
+    }
+
+    void writeBuffer(std::ofstream &out, std::vector<unsigned char> &buffer)
+    {
+        out.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+        buffer.clear();
+
+        if (!out)
+            throw Batch::FormatException();
+    }
+}
+
+Batch::MappedFile::MappedFile(const std::string &path)
+{
+#ifndef _WIN32
+    int fd{::open(path.c_str(), O_RDONLY)};
+    if (fd < 0)
+        throw FormatException();
+
+    struct stat info
+    {
+    };
+    if (::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        throw FormatException();
+    }
+    length = info.st_size;
+
+    if (length > 0)
+    {
+        void *mapped{::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0)};
+        if (mapped != MAP_FAILED)
+        {
+            data = static_cast<const unsigned char *>(mapped);
+
+            // Records are mostly read in order
+            ::madvise(mapped, length, MADV_SEQUENTIAL);
+        }
+    }
+    ::close(fd);
+
+    if (data != nullptr || length == 0)
+        return;
+#endif
+
+    std::ifstream in{path, std::ios::binary};
+    buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (!in && !in.eof())
+        throw FormatException();
+
+    data = buffer.data();
+    length = buffer.size();
+}
+
+Batch::MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+    if (buffer.empty() && data != nullptr)
+        ::munmap(const_cast<unsigned char *>(data), length);
+#endif
+}
+
+std::size_t Batch::recordSize(int dimension, Encoding encoding)
+{
+    int cells{dimension * dimension};
+
+    if (encoding == Encoding::PACKED && dimension >= 2 && dimension <= 16)
+        return cells <= 16 ? (cells + 1) / 2 : cells;
+
+    if (encoding == Encoding::RANK && dimension >= 2 && dimension <= Puzzle::PACK_MAX_DIMENSION)
+    {
+        // Bytes to hold the largest rank
+        std::uint64_t largest{Rank::size(cells, cells) - 1};
+        std::size_t bytes{0};
+        for (; largest > 0; largest >>= 8)
+            bytes++;
+
+        return bytes;
+    }
+
+    throw FormatException();
+}
+
+Batch::InstanceReader::InstanceReader(const std::string &path)
+    : file(path)
+{
+    const unsigned char *header{file.get()};
+    if (file.size() < INSTANCE_HEADER_SIZE || std::memcmp(header, INSTANCE_MAGIC, 4) != 0 || header[4] != VERSION)
+        throw FormatException();
+
+    dimension = header[5];
+    encoding = static_cast<Encoding>(header[6]);
+    count = getLE(header + 8, 8);
+    stride = recordSize(dimension, encoding);
+
+    if ((file.size() - INSTANCE_HEADER_SIZE) / stride < count)
+        throw FormatException();
+}
+
+int Batch::InstanceReader::getDimension() const
+{
+    return dimension;
+}
+
+Batch::Encoding Batch::InstanceReader::getEncoding() const
+{
+    return encoding;
+}
+
+std::uint64_t Batch::InstanceReader::size() const
+{
+    return count;
+}
+
+void Batch::InstanceReader::get(std::uint64_t n, Puzzle &puzzle) const
+{
+    if (n >= count)
+        throw std::out_of_range("instance index out of range");
+
+    const unsigned char *record{file.get() + INSTANCE_HEADER_SIZE + (n * stride)};
+    int cells{dimension * dimension};
+
+    if (puzzle.getDimension() != dimension)
+        puzzle = Puzzle(cells - 1);
+
+    // Boards over 4x4 store a byte per tile
+    if (cells > 16)
+    {
+        if (!puzzle.setTiles(std::vector<int>(record, record + cells)))
+            throw FormatException();
+        return;
+    }
+
+    std::uint64_t packed{0};
+    if (encoding == Encoding::RANK)
+    {
+        // Larger ranks would wrap around to some other permutation
+        std::uint64_t rank{getLE(record, stride)};
+        if (rank >= Rank::size(cells, cells))
+            throw FormatException();
+
+        int items[16];
+        Rank::unrank(rank, items, cells, cells);
+
+        for (int i{0}; i < cells; i++)
+            packed |= static_cast<std::uint64_t>(items[i]) << (4 * i);
+    }
+    else
+    {
+        packed = getLE(record, stride);
+    }
+
+    // Every tile must appear exactly once
+    unsigned int seen{0};
+    for (int i{0}; i < cells; i++)
+        seen |= 1u << ((packed >> (4 * i)) & 0xF);
+    if (seen != (1u << cells) - 1)
+        throw FormatException();
+
+    puzzle.unpack(packed);
+}
+
+Puzzle Batch::InstanceReader::get(std::uint64_t n) const
+{
+    Puzzle puzzle{dimension * dimension - 1};
+    get(n, puzzle);
+
+    return puzzle;
+}
+
+Batch::SolutionReader::SolutionReader(const std::string &path)
+    : file(path)
+{
+    const unsigned char *header{file.get()};
+    if (file.size() < SOLUTION_HEADER_SIZE || std::memcmp(header, SOLUTION_MAGIC, 4) != 0 || header[4] != VERSION)
+        throw FormatException();
+
+    count = getLE(header + 8, 8);
+    std::uint64_t position{getLE(header + 16, 8)};
+
+    if (position < SOLUTION_HEADER_SIZE || position > file.size() || (file.size() - position) / 8 <= count)
+        throw FormatException();
+
+    moves = file.get() + SOLUTION_HEADER_SIZE;
+    index = file.get() + position;
+
+    // Offsets never decrease and the last one is the total number of moves, which must fit
+    // before the index, so every solution lies within the file
+    for (std::uint64_t n{0}; n < count; n++)
+    {
+        if (offset(n + 1) < offset(n))
+            throw FormatException();
+    }
+    if ((offset(count) + 3) / 4 > position - SOLUTION_HEADER_SIZE)
+        throw FormatException();
+}
+
+std::uint64_t Batch::SolutionReader::offset(std::uint64_t n) const
+{
+    return getLE(index + (8 * n), 8) & ~UNSOLVED;
+}
+
+std::uint64_t Batch::SolutionReader::size() const
+{
+    return count;
+}
+
+bool Batch::SolutionReader::solved(std::uint64_t n) const
+{
+    if (n >= count)
+        throw std::out_of_range("solution index out of range");
+
+    return (getLE(index + (8 * n), 8) & UNSOLVED) == 0;
+}
+
+std::uint64_t Batch::SolutionReader::length(std::uint64_t n) const
+{
+    if (n >= count)
+        throw std::out_of_range("solution index out of range");
+
+    return offset(n + 1) - offset(n);
+}
+
+std::vector<Puzzle::Move> Batch::SolutionReader::get(std::uint64_t n) const
+{
+    if (n >= count)
+        throw std::out_of_range("solution index out of range");
+
+    std::uint64_t begin{offset(n)}, end{offset(n + 1)};
+
+    std::vector<Puzzle::Move> solution{};
+    solution.reserve(end - begin);
+
+    for (std::uint64_t m{begin}; m < end; m++)
+        solution.push_back(static_cast<Puzzle::Move>((moves[m / 4] >> (2 * (m % 4))) & 3));
+
+    return solution;
+}
+
+Batch::InstanceWriter::InstanceWriter(const std::string &path, int dimension, Encoding encoding)
+    : out(path, std::ios::binary | std::ios::trunc), dimension(dimension), encoding(encoding), stride(recordSize(dimension, encoding))
+{
+    if (!out)
+        throw FormatException();
+
+    // Header is filled in on close, once the count is known
+    buffer.reserve(BUFFER_SIZE + stride);
+    buffer.resize(INSTANCE_HEADER_SIZE);
+    items.resize(dimension * dimension);
+}
+
+Batch::InstanceWriter::~InstanceWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+        // Destructors must not throw, call close() to see errors
+    }
+}
+
+void Batch::InstanceWriter::flush()
+{
+    writeBuffer(out, buffer);
+}
+
+void Batch::InstanceWriter::write(const Puzzle &puzzle)
+{
+    if (puzzle.getDimension() != dimension || !out.is_open())
+        throw FormatException();
+
+    int cells{dimension * dimension};
+
+    if (cells > 16)
+    {
+        for (int i{0}; i < cells; i++)
+            buffer.push_back(static_cast<unsigned char>(puzzle.get(i)));
+    }
+    else if (encoding == Encoding::RANK)
+    {
+        for (int i{0}; i < cells; i++)
+            items[i] = puzzle.get(i);
+
+        putLE(buffer, Rank::rank(items.data(), cells, cells), stride);
+    }
+    else
+    {
+        putLE(buffer, puzzle.pack(), stride);
+    }
+
+    count++;
+    if (buffer.size() >= BUFFER_SIZE)
+        flush();
+}
+
+void Batch::InstanceWriter::close()
+{
+    if (!out.is_open())
+        return;
+
+    flush();
+
+    std::vector<unsigned char> header(INSTANCE_MAGIC, INSTANCE_MAGIC + 4);
+    header.push_back(VERSION);
+    header.push_back(static_cast<unsigned char>(dimension));
+    header.push_back(encoding);
+    header.push_back(0);
+    putLE(header, count, 8);
+
+    out.seekp(0);
+    writeBuffer(out, header);
+    out.close();
+
+    if (!out)
+        throw FormatException();
+}
+
+Batch::SolutionWriter::SolutionWriter(const std::string &path)
+    : path(path), indexPath(path + ".index"), out(path, std::ios::binary | std::ios::trunc), indexOut(indexPath, std::ios::binary | std::ios::trunc)
+{
+    if (!out || !indexOut)
+        throw FormatException();
+
+    // Header is filled in on close
+    buffer.reserve(BUFFER_SIZE);
+    buffer.resize(SOLUTION_HEADER_SIZE);
+    indexBuffer.reserve(BUFFER_SIZE);
+}
+
+Batch::SolutionWriter::~SolutionWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+        // Destructors must not throw, call close() to see errors
+    }
+}
+
+void Batch::SolutionWriter::flush()
+{
+    // A byte still taking moves stays behind
+    unsigned char partial{};
+    bool keep{moves % 4 != 0 && !buffer.empty()};
+    if (keep)
+    {
+        partial = buffer.back();
+        buffer.pop_back();
+    }
+
+    writeBuffer(out, buffer);
+
+    if (keep)
+        buffer.push_back(partial);
+}
+
+void Batch::SolutionWriter::add(std::uint64_t offset)
+{
+    putLE(indexBuffer, offset, 8);
+    if (indexBuffer.size() >= BUFFER_SIZE)
+        writeBuffer(indexOut, indexBuffer);
+}
+
+void Batch::SolutionWriter::write(const std::vector<Puzzle::Move> &solution)
+{
+    if (!out.is_open())
+        throw FormatException();
+
+    add(moves);
+    count++;
+
+    for (Puzzle::Move move : solution)
+    {
+        if (moves % 4 == 0)
+            buffer.push_back(0);
+
+        buffer.back() |= static_cast<unsigned char>(move) << (2 * (moves % 4));
+        moves++;
+    }
+
+    if (buffer.size() >= BUFFER_SIZE)
+        flush();
+}
+
+void Batch::SolutionWriter::writeUnsolved()
+{
+    if (!out.is_open())
+        throw FormatException();
+
+    add(moves | UNSOLVED);
+    count++;
+}
+
+void Batch::SolutionWriter::close()
+{
+    if (!out.is_open())
+        return;
+
+    // Moves, including a last partial byte
+    writeBuffer(out, buffer);
+    std::uint64_t position{SOLUTION_HEADER_SIZE + ((moves + 3) / 4)};
+
+    // Index, with the end offset of the last solution
+    add(moves);
+    writeBuffer(indexOut, indexBuffer);
+    indexOut.close();
+
+    std::ifstream in{indexPath, std::ios::binary};
+    out << in.rdbuf();
+    in.close();
+    std::remove(indexPath.c_str());
+
+    std::vector<unsigned char> header(SOLUTION_MAGIC, SOLUTION_MAGIC + 4);
+    header.push_back(VERSION);
+    header.resize(8, 0);
+    putLE(header, count, 8);
+    putLE(header, position, 8);
+    putLE(header, 0, 8);
+
+    out.seekp(0);
+    writeBuffer(out, header);
+    out.close();
+
+    if (!out)
+        throw FormatException();
+}
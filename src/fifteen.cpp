@@ -1,13 +1,14 @@
 #include <string>
 #include <memory>
-#include <thread>
-#include <atomic>
 #include <vector>
 #include <functional>
 #include <sstream>
+#include <algorithm>
+#include <iterator>
 
 #include <Fl/Fl.H>
 #include <Fl/Fl_Widget.H>
+#include <Fl/Fl_Button.H>
 #include <Fl/fl_ask.H>
 
 #include "main.fl.h"
@@ -16,13 +17,18 @@
 #include "strings.h"
 #include "puzzle.h"
 #include "heuristic.h"
+#include "stream.h"
 
 static const char FLTK_SCHEME[] = "gleam";
 
 class FifteenApp
 {
 private:
-    static const int PUZZLE_SIZE{15};
+    static const int DEFAULT_DIMENSION{4};
+    // Margin between the puzzle group frame and the tiles
+    static const int TILE_MARGIN{5};
+    // Larger boards are only solved on request, optimal solutions are out of reach in the background
+    static const int SPECULATE_MAX_DIMENSION{4};
 
     enum UiMode
     {
@@ -34,34 +40,30 @@ private:
     MainUi ui{};
     UiMode mode{UiMode::DEFAULT};
 
-    Puzzle puzzle{PUZZLE_SIZE};
+    int dimension{DEFAULT_DIMENSION};
+    Puzzle puzzle{DEFAULT_DIMENSION * DEFAULT_DIMENSION - 1};
     std::shared_ptr<Puzzle::Heuristic> heuristic{};
 
-    std::atomic<bool> solving{false};
+    // Tile values and metrics currently shown, so only what changed gets updated
+    std::vector<int> shownTiles{};
+    unsigned int heuristicValue{};
+    unsigned int inversions{};
 
-    std::vector<Puzzle> solverStates{};
+    // Solve of the board in progress, searched a slice of a few milliseconds at a time whenever the GUI is idle
+    std::unique_ptr<SolverStream> stream{};
+
+    // Solution is kept as moves applied to solverPuzzle, which is the state being shown
+    std::vector<Puzzle::Move> solverMoves{};
+    Puzzle solverPuzzle{puzzle};
     int solverStep{-1};
     long double secElapsed{};
+    // Moves are still being added to the solution shown
+    bool solverStreaming{false};
 
-    struct ThreadResult
-    {
-        enum Result
-        {
-            SOLVED,
-            CANCELLED,
-            UNSOLVABLE,
-            FAILURE
-        };
-
-        FifteenApp *app{};
-
-        const Result result{};
-        const std::vector<Puzzle> states{};
-        const std::chrono::nanoseconds timeElapsed{};
-
-        ThreadResult(FifteenApp *app, Result result, std::vector<Puzzle> &&states, const std::chrono::nanoseconds timeElapsed)
-            : app(app), result(result), states(std::move(states)), timeElapsed(timeElapsed){};
-    };
+    // Optimal solution found in the background, the board is knownStep moves along it (-1 if none)
+    std::vector<Puzzle::Move> knownMoves{};
+    int knownStep{-1};
+    long double knownSecElapsed{};
 
     struct TileData
     {
@@ -80,17 +82,21 @@ public:
         // Set callbacks for UI elements
         setCallbacks();
 
+        buildTiles();
+
         // Select linear conflict heuristic as default
         ui.linRadButton->set();
-        heuristic = std::make_shared<Heuristic::ManhattanDistanceHeuristic>();
+        heuristic = std::make_shared<Heuristic::LinearConflictTableHeuristic>();
 
         updateUi(puzzle);
+        speculate();
 
         ui.show();
     };
 
     ~FifteenApp()
     {
+        stopSolver();
         freeUserData();
     };
 
@@ -104,25 +110,34 @@ private:
         if (mode != UiMode::DEFAULT)
             return 0;
 
+        Puzzle::Move move{};
+
         char key{(char)Fl::event_key()};
         switch (key)
         {
         case 'w':
-            puzzle.move(Puzzle::Move::UP);
+            move = Puzzle::Move::UP;
             break;
         case 's':
-            puzzle.move(Puzzle::Move::DOWN);
+            move = Puzzle::Move::DOWN;
             break;
         case 'a':
-            puzzle.move(Puzzle::Move::LEFT);
+            move = Puzzle::Move::LEFT;
             break;
         case 'd':
-            puzzle.move(Puzzle::Move::RIGHT);
+            move = Puzzle::Move::RIGHT;
             break;
         default:
             return 0;
         }
-        updateUi(puzzle);
+
+        if (puzzle.move(move))
+        {
+            updateUi(puzzle, move);
+
+            followKnownPath(move);
+            speculate();
+        }
 
         return 1;
     }
@@ -157,6 +172,9 @@ private:
         puzzle.set(index, value);
         updateUi(puzzle);
 
+        forgetKnownPath();
+        speculate();
+
         return true;
     }
 
@@ -202,16 +220,25 @@ private:
 
     void nextButtonCb()
     {
+        Puzzle::Move move{solverMoves[solverStep]};
+        solverPuzzle.move(move);
+
         solverStep++;
         updateStepLabel();
 
         if (!ui.prevButton->active())
             ui.prevButton->activate();
 
-        updateUi(solverStates[solverStep]);
+        updateUi(solverPuzzle, move);
 
-        if (solverStep + 1 == static_cast<int>(solverStates.size()))
+        if (solverStep == static_cast<int>(solverMoves.size()))
+        {
             ui.nextButton->deactivate();
+
+            // Playback waits for the rest of a solution still coming in
+            if (!solverStreaming)
+                stopPlayback();
+        }
     }
 
     void prevButtonCb()
@@ -219,48 +246,176 @@ private:
         solverStep--;
         updateStepLabel();
 
+        Puzzle::Move move{Puzzle::inverse(solverMoves[solverStep])};
+        solverPuzzle.move(move);
+
         if (!ui.nextButton->active())
             ui.nextButton->activate();
 
-        updateUi(solverStates[solverStep]);
+        updateUi(solverPuzzle, move);
 
         if (solverStep == 0)
             ui.prevButton->deactivate();
     }
 
+    void playButtonCb()
+    {
+        if (ui.playButton->value())
+            startPlayback();
+        else
+            stopPlayback();
+    }
+
+    void startPlayback()
+    {
+        // Start over when the end was already reached
+        if (solverStep == static_cast<int>(solverMoves.size()) && !solverStreaming)
+        {
+            solverStep = 0;
+            solverPuzzle = puzzle;
+            updateStepLabel();
+            updateUi(solverPuzzle);
+
+            ui.prevButton->deactivate();
+            ui.nextButton->activate();
+        }
+
+        ui.playButton->value(1);
+        ui.playButton->label(strings::BUTTON_PAUSE);
+
+        Fl::add_timeout(1.0 / ui.rateSlider->value(), playbackTimeout, this);
+    }
+
+    void stopPlayback()
+    {
+        Fl::remove_timeout(playbackTimeout, this);
+
+        ui.playButton->value(0);
+        ui.playButton->label(strings::BUTTON_PLAY);
+    }
+
+    static void playbackTimeout(void *d)
+    {
+        static_cast<FifteenApp *>(d)->playbackTimeoutCb();
+    }
+
+    void playbackTimeoutCb()
+    {
+        if (mode != UiMode::SOLVER || (solverStep == static_cast<int>(solverMoves.size()) && !solverStreaming))
+        {
+            stopPlayback();
+            return;
+        }
+
+        if (solverStep < static_cast<int>(solverMoves.size()))
+            nextButtonCb();
+
+        // Keep stepping at the chosen rate unless the last step stopped playback
+        if (ui.playButton->value())
+            Fl::repeat_timeout(1.0 / ui.rateSlider->value(), playbackTimeout, this);
+    }
+
+    void sizeChangeCb()
+    {
+        int value{static_cast<int>(ui.sizeSpinner->value())};
+        if (mode != UiMode::DEFAULT || value == dimension)
+            return;
+
+        dimension = value;
+        puzzle = Puzzle(dimension * dimension - 1);
+
+        buildTiles();
+        updateUi(puzzle);
+
+        forgetKnownPath();
+        speculate();
+    }
+
     void hueChangeCb(std::shared_ptr<Puzzle::Heuristic> heuristic)
     {
         this->heuristic = heuristic;
-        updateUi(puzzle);
+        updateUi(mode == UiMode::SOLVER ? solverPuzzle : puzzle);
     }
 
-    void solveThreadCb(ThreadResult *threadResult)
+    static void solverIdle(void *d)
     {
-        solving = false;
+        static_cast<FifteenApp *>(d)->solverIdleCb();
+    }
 
-        switch (threadResult->result)
+    // Pulls events from the solve of the board until a slice was searched, a move came in or it finished
+    void solverIdleCb()
+    {
+        SolverStream::Event event{};
+        while (stream->next(event))
         {
-        case ThreadResult::SOLVED:
-            solverStates = std::move(threadResult->states);
-            solverStep = 0;
-            secElapsed = threadResult->timeElapsed.count() / 1000000000.0L;
+            switch (event.type)
+            {
+            case SolverStream::Event::ITERATION:
+            case SolverStream::Event::PROGRESS:
+                if (mode == UiMode::SOLVING)
+                    updateProgressLabel(event);
+                return;
+            case SolverStream::Event::MOVE:
+                addSolutionMove(event.move);
+                return;
+            case SolverStream::Event::SOLVED:
+                // Solves always belong to the current board, keep the result for when it is asked for
+                knownStep = 0;
+                knownSecElapsed = stream->getElapsed().count() / 1000000000.0L;
+
+                if (solverStreaming)
+                {
+                    solverStreaming = false;
+                    secElapsed = knownSecElapsed;
+                    updateElapsedLabel();
+                }
+                else if (mode == UiMode::SOLVING)
+                {
+                    showSolution(knownMoves, knownSecElapsed);
+                }
+                break;
+            case SolverStream::Event::UNSOLVABLE:
+                if (mode == UiMode::SOLVING)
+                {
+                    fl_alert(strings::ALERT_UNSOLVABLE_PUZZLE);
+                    setUiMode(UiMode::DEFAULT);
+                }
+                break;
+            case SolverStream::Event::FAILED:
+                if (mode == UiMode::SOLVING)
+                {
+                    fl_alert(strings::ALERT_SOLVE_FAILED);
+                    setUiMode(UiMode::DEFAULT);
+                }
+                break;
+            }
+        }
 
-            setUiMode(UiMode::SOLVER);
-            break;
-        case ThreadResult::UNSOLVABLE:
-            fl_alert(strings::ALERT_UNSOLVABLE_PUZZLE);
+        // Nothing left to search
+        Fl::remove_idle(solverIdle, this);
+    }
 
-            setUiMode(UiMode::DEFAULT);
-            break;
-        case ThreadResult::FAILURE:
-            fl_alert(strings::ALERT_SOLVE_FAILED);
+    // Playback of a solve asked for starts with the moves found so far, before the rest has come in
+    void addSolutionMove(Puzzle::Move move)
+    {
+        knownMoves.push_back(move);
 
-            setUiMode(UiMode::DEFAULT);
-            break;
-        case ThreadResult::CANCELLED:
-            setUiMode(UiMode::DEFAULT);
-            break;
+        if (mode == UiMode::SOLVING)
+        {
+            // The solve may have been asked for after the background solve streamed earlier moves
+            showSolution(knownMoves, stream->getElapsed().count() / 1000000000.0L);
+            solverStreaming = true;
+            return;
         }
+
+        if (mode != UiMode::SOLVER || !solverStreaming)
+            return;
+
+        solverMoves.push_back(move);
+        updateStepLabel();
+
+        if (solverStep < static_cast<int>(solverMoves.size()))
+            ui.nextButton->activate();
     }
 
     void solveButtonCb()
@@ -271,47 +426,81 @@ private:
             return;
         }
 
+        // Already solved in the background
+        if (knownStep >= 0)
+        {
+            showSolution(std::vector<Puzzle::Move>(knownMoves.begin() + knownStep, knownMoves.end()), knownSecElapsed);
+            return;
+        }
+
         setUiMode(UiMode::SOLVING);
-        spawnSolverThread();
+
+        // Wait for the background solve of this board unless there is none
+        if (!stream || !(stream->getPuzzle() == puzzle) || stream->finished())
+            startSolver();
     }
 
-    void spawnSolverThread()
+    void showSolution(const std::vector<Puzzle::Move> &moves, long double seconds)
     {
-        solving = true;
-        std::thread thread([&]()
-                           {
-            ThreadResult::Result result{ThreadResult::Result::SOLVED};
-            std::vector<Puzzle> states{};
-            auto startTime{std::chrono::high_resolution_clock::now()};
+        solverMoves = moves;
+        solverPuzzle = puzzle;
+        solverStep = 0;
+        secElapsed = seconds;
+        solverStreaming = false;
 
-            try
-            {
-                states = std::move(puzzle.solve(*heuristic, solving));
-            }
-            catch (Puzzle::CancelledException &)
-            {
-                result = ThreadResult::Result::CANCELLED;
-            }
-            catch (Puzzle::UnsolvableException &)
-            {
-                result = ThreadResult::Result::UNSOLVABLE;
-            }
-            catch (...)
-            {
-                result = ThreadResult::Result::FAILURE;
-            }
+        setUiMode(UiMode::SOLVER);
+    }
 
-            auto endTime = std::chrono::high_resolution_clock::now();
-            auto timeElapsed{std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime)};
+    // Keep the known solution while the board moves along it, in either direction
+    void followKnownPath(Puzzle::Move move)
+    {
+        if (knownStep < 0)
+            return;
 
-            ThreadResult *threadResult{new ThreadResult(this, result, std::move(states), timeElapsed)};
+        if (knownStep < static_cast<int>(knownMoves.size()) && move == knownMoves[knownStep])
+            knownStep++;
+        else if (knownStep > 0 && move == Puzzle::inverse(knownMoves[knownStep - 1]))
+            knownStep--;
+        else
+            forgetKnownPath();
+    }
 
-            Fl::awake([](void *d){
-                ThreadResult *threadResult{static_cast<ThreadResult *>(d)};
-                threadResult->app->solveThreadCb(threadResult);
-                delete threadResult;
-            }, threadResult); });
-        thread.detach();
+    void forgetKnownPath()
+    {
+        knownMoves.clear();
+        knownStep = -1;
+    }
+
+    // Solve the board in the background, replacing the solve of an earlier board
+    void speculate()
+    {
+        if (knownStep >= 0)
+            return;
+
+        if (dimension > SPECULATE_MAX_DIMENSION || puzzle.isSolved() || !puzzle.isSolvable())
+        {
+            stopSolver();
+            return;
+        }
+
+        startSolver();
+    }
+
+    void startSolver()
+    {
+        stopSolver();
+
+        // The stream solves a copy of the puzzle, the board can be edited while it runs
+        stream = std::make_unique<SolverStream>(puzzle, heuristic);
+        knownMoves.clear();
+
+        Fl::add_idle(solverIdle, this);
+    }
+
+    void stopSolver()
+    {
+        Fl::remove_idle(solverIdle, this);
+        stream.reset();
     }
 
     void shuffleButtonCb()
@@ -322,16 +511,19 @@ private:
         case UiMode::DEFAULT:
             // Create a new puzzle if not solvable
             if (!puzzle.isSolvable())
-                puzzle = Puzzle(PUZZLE_SIZE);
+                puzzle = Puzzle(dimension * dimension - 1);
             else
                 puzzle.shuffle();
 
             updateUi(puzzle);
 
+            forgetKnownPath();
+            speculate();
+
             break;
         // Abort
         case UiMode::SOLVING:
-            solving = false;
+            stopSolver();
             setUiMode(UiMode::DEFAULT);
 
             break;
@@ -342,7 +534,8 @@ private:
             updateUi(puzzle);
 
             solverStep = -1;
-            solverStates.clear();
+            solverMoves.clear();
+            solverStreaming = false;
 
             break;
         default:
@@ -365,7 +558,11 @@ private:
             ui.prevButton->deactivate();
             ui.nextButton->deactivate();
 
+            stopPlayback();
+            ui.playButton->deactivate();
+
             ui.heuGroup->activate();
+            ui.sizeSpinner->activate();
 
             break;
         case SOLVING:
@@ -377,6 +574,7 @@ private:
             ui.shuffleButton->label(strings::BUTTON_ABORT);
 
             ui.heuGroup->deactivate();
+            ui.sizeSpinner->deactivate();
 
             break;
         case SOLVER:
@@ -387,7 +585,12 @@ private:
 
             ui.shuffleButton->label(strings::BUTTON_RETURN);
 
+            // Reached straight from DEFAULT when the solution was found in the background
+            ui.heuGroup->deactivate();
+            ui.sizeSpinner->deactivate();
+
             ui.nextButton->activate();
+            ui.playButton->activate();
         }
     }
 
@@ -400,10 +603,29 @@ private:
         ui.elapsedOutput->value(secStringStream.str().c_str());
     }
 
+    // Threshold and node count of the solve in progress, shortened to fit the elapsed time field
+    void updateProgressLabel(const SolverStream::Event &event)
+    {
+        static const char SUFFIXES[][2]{"", "K", "M", "G", "T"};
+
+        double nodes{static_cast<double>(event.nodes)};
+        std::size_t suffix{0};
+        while (nodes >= 1000 && suffix + 1 < std::size(SUFFIXES))
+        {
+            nodes /= 1000;
+            suffix++;
+        }
+
+        std::ostringstream progressStringStream{};
+        progressStringStream.precision(suffix > 0 ? 1 : 0);
+        progressStringStream << std::fixed << strings::LABEL_THRESHOLD << event.threshold << ' ' << nodes << SUFFIXES[suffix];
+        ui.elapsedOutput->value(progressStringStream.str().c_str());
+    }
+
     void updateStepLabel()
     {
         std::ostringstream stepStringStream{};
-        stepStringStream << strings::BUTTON_STEP << solverStep << '/' << (solverStates.size() - 1);
+        stepStringStream << strings::BUTTON_STEP << solverStep << '/' << solverMoves.size();
         ui.solveButton->copy_label(stepStringStream.str().c_str());
     }
 
@@ -436,7 +658,7 @@ private:
                                    this);
 
         ui.linRadButton->callback([](Fl_Widget *, void *d)
-                                  { static_cast<FifteenApp *>(d)->hueChangeCb(std::make_shared<Heuristic::LinearConflictHeuristic>()); },
+                                  { static_cast<FifteenApp *>(d)->hueChangeCb(std::make_shared<Heuristic::LinearConflictTableHeuristic>()); },
                                   this);
         ui.manRadButton->callback([](Fl_Widget *, void *d)
                                   { static_cast<FifteenApp *>(d)->hueChangeCb(std::make_shared<Heuristic::ManhattanDistanceHeuristic>()); },
@@ -452,12 +674,32 @@ private:
                                 { static_cast<FifteenApp *>(d)->prevButtonCb(); },
                                 this);
 
-        Fl_Widget *const *tiles{ui.puzzleGroup->array()};
-        int count{ui.puzzleGroup->children()};
+        ui.playButton->callback([](Fl_Widget *, void *d)
+                                { static_cast<FifteenApp *>(d)->playButtonCb(); },
+                                this);
+        ui.sizeSpinner->callback([](Fl_Widget *, void *d)
+                                 { static_cast<FifteenApp *>(d)->sizeChangeCb(); },
+                                 this);
+    }
 
-        for (int n{0}; n < count; n++)
+    // (Re)create one tile button per board cell, sized to fit the puzzle group
+    void buildTiles()
+    {
+        freeUserData();
+        ui.puzzleGroup->clear();
+
+        int area{ui.puzzleGroup->w() - (TILE_MARGIN * 2)};
+        int tileSize{area / dimension};
+        int offset{TILE_MARGIN + ((area - (tileSize * dimension)) / 2)};
+        int labelSize{std::max(8, std::min(14, (tileSize * 2) / 5))};
+
+        ui.puzzleGroup->begin();
+        for (int n{0}, len{dimension * dimension}; n < len; n++)
         {
-            Fl_Widget *const tile{tiles[n]};
+            Fl_Button *tile{new Fl_Button(ui.puzzleGroup->x() + offset + ((n % dimension) * tileSize),
+                                          ui.puzzleGroup->y() + offset + ((n / dimension) * tileSize),
+                                          tileSize, tileSize)};
+            tile->labelsize(labelSize);
 
             tile->callback([](Fl_Widget *, void *d)
                            {
@@ -465,35 +707,83 @@ private:
                 data->app->editTileCb(data->index); },
                            new TileData(this, n));
         }
+        ui.puzzleGroup->end();
+        ui.puzzleGroup->redraw();
+
+        // Nothing is shown yet, force every tile to be labeled
+        shownTiles.assign(dimension * dimension, -1);
     }
 
-    void updateUi(const Puzzle &puzzle)
+    // Change in inversion count caused by the last move
+    static int inversionDelta(const Puzzle &puzzle, Puzzle::Move move)
     {
-        Fl_Widget *const *tiles{ui.puzzleGroup->array()};
-        int count{ui.puzzleGroup->children()};
+        // Horizontal moves keep the order of tiles
+        if (move == Puzzle::Move::LEFT || move == Puzzle::Move::RIGHT)
+            return 0;
 
-        for (int n{0}; n < count; n++)
-        {
-            Fl_Widget *const tile{tiles[n]};
+        // A vertical move makes the tile jump over the tiles between its old and new position
+        int blank{puzzle.getBlank()};
+        int moved{puzzle.movedTileIndex(move)};
+        int value{puzzle.get(moved)};
 
-            int value{puzzle.get(n)};
-            if (value > 0)
-            {
-                std::string tileStr{std::to_string(value)};
-                tile->copy_label(tileStr.c_str());
-            }
-            else
-            {
-                tile->label(NULL);
-            }
+        int delta{0};
+        for (int n{std::min(blank, moved) + 1}, end{std::max(blank, moved)}; n < end; n++)
+            delta += (puzzle.get(n) > value) ? 1 : -1;
+
+        // Moving down places the tile after the others, moving up before them
+        return (move == Puzzle::Move::UP) ? delta : -delta;
+    }
+
+    void updateTile(const Puzzle &puzzle, int index)
+    {
+        int value{puzzle.get(index)};
+        if (shownTiles[index] == value)
+            return;
+
+        Fl_Widget *const tile{ui.puzzleGroup->child(index)};
+        if (value > 0)
+        {
+            std::string tileStr{std::to_string(value)};
+            tile->copy_label(tileStr.c_str());
         }
+        else
+        {
+            tile->label(NULL);
+        }
+        tile->redraw();
+
+        shownTiles[index] = value;
+    }
 
-        std::string hueStr{std::to_string((*heuristic)(puzzle))};
+    void updateMetrics()
+    {
+        std::string hueStr{std::to_string(heuristicValue)};
         ui.heuOutput->value(hueStr.c_str());
 
-        std::string invStr{std::to_string(puzzle.inversionCount())};
+        std::string invStr{std::to_string(inversions)};
         ui.invOutput->value(invStr.c_str());
     }
+
+    void updateUi(const Puzzle &puzzle)
+    {
+        for (int n{0}, len{dimension * dimension}; n < len; n++)
+            updateTile(puzzle, n);
+
+        heuristicValue = (*heuristic)(puzzle);
+        inversions = puzzle.inversionCount();
+        updateMetrics();
+    }
+
+    // Cheaper update after a single move: only two tiles changed and metrics are updated incrementally
+    void updateUi(const Puzzle &puzzle, Puzzle::Move move)
+    {
+        updateTile(puzzle, puzzle.getBlank());
+        updateTile(puzzle, puzzle.movedTileIndex(move));
+
+        heuristicValue = heuristic->update(puzzle, heuristicValue, move);
+        inversions += inversionDelta(puzzle, move);
+        updateMetrics();
+    }
 };
 
 int main()
@@ -502,8 +792,5 @@ int main()
 
     Fl::scheme(FLTK_SCHEME);
 
-    // Enable multithreading support in FLTK
-    Fl::lock();
-
     return Fl::run();
 }
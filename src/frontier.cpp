@@ -0,0 +1,434 @@
+#include "frontier.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "rank.h"
+
+Frontier::Space::Space(int rows, int cols, std::vector<int> tiles)
+    : rows(rows), cols(cols), tiles(std::move(tiles))
+{
+}
+
+std::uint64_t Frontier::Space::size() const
+{
+    return Rank::size(items(), cells());
+}
+
+std::uint64_t Frontier::Space::goal() const
+{
+    std::vector<int> positions(items());
+
+    positions[0] = cells() - 1;
+    for (std::size_t n{0}; n < tiles.size(); n++)
+        positions[n + 1] = tiles[n] - 1;
+
+    return Rank::rank(positions.data(), items(), cells());
+}
+
+void Frontier::Space::expand(std::uint64_t rank, std::vector<int> &positions, std::vector<int> &occupant, std::vector<std::uint64_t> &out) const
+{
+    Rank::unrank(rank, positions.data(), items(), cells());
+
+    std::fill(occupant.begin(), occupant.end(), -1);
+    for (int n{1}; n < items(); n++)
+        occupant[positions[n]] = n;
+
+    int blank{positions[0]};
+    int row{blank / cols}, col{blank % cols};
+
+    const int neighbours[4][2]{{row - 1, col}, {row + 1, col}, {row, col - 1}, {row, col + 1}};
+    for (const auto &neighbour : neighbours)
+    {
+        if (neighbour[0] < 0 || neighbour[0] >= rows || neighbour[1] < 0 || neighbour[1] >= cols)
+            continue;
+
+        int cell{(neighbour[0] * cols) + neighbour[1]};
+        int tile{occupant[cell]};
+
+        // Slide the tile into the blank, untracked tiles need no bookkeeping
+        positions[0] = cell;
+        if (tile > 0)
+            positions[tile] = blank;
+
+        out.push_back(Rank::rank(positions.data(), items(), cells()));
+
+        positions[0] = blank;
+        if (tile > 0)
+            positions[tile] = cell;
+    }
+}
+
+std::string Frontier::Space::format(std::uint64_t rank) const
+{
+    std::vector<int> positions(items());
+    Rank::unrank(rank, positions.data(), items(), cells());
+
+    std::vector<int> board(cells(), -1);
+    board[positions[0]] = 0;
+    for (std::size_t n{0}; n < tiles.size(); n++)
+        board[positions[n + 1]] = tiles[n];
+
+    std::ostringstream stream{};
+    for (int n{0}; n < cells(); n++)
+    {
+        if (board[n] < 0)
+            stream << " *";
+        else if (board[n] == 0)
+            stream << " _";
+        else
+            stream << ' ' << board[n];
+
+        stream << ((n % cols == cols - 1) ? '\n' : ' ');
+    }
+
+    return stream.str();
+}
+
+Frontier::LayerWriter::LayerWriter(const std::string &path)
+    : file(path, std::ios::binary | std::ios::trunc)
+{
+    if (!file)
+        throw std::runtime_error("Failed to create " + path);
+
+    buffer.reserve(IO_BUFFER_SIZE);
+}
+
+Frontier::LayerWriter::~LayerWriter()
+{
+    if (!file.is_open())
+        return;
+
+    try
+    {
+        close();
+    }
+    catch (const std::exception &)
+    {
+        // Only reached while unwinding from another error
+    }
+}
+
+void Frontier::LayerWriter::flush()
+{
+    file.write(buffer.data(), buffer.size());
+    if (!file)
+        throw std::runtime_error("Failed to write layer file");
+
+    buffer.clear();
+}
+
+void Frontier::LayerWriter::write(std::uint64_t rank)
+{
+    std::uint64_t delta{rank - last};
+    last = rank;
+    count++;
+
+    // Little endian base 128, high bit set on all but the last byte
+    while (delta >= 0x80)
+    {
+        buffer.push_back(static_cast<char>((delta & 0x7F) | 0x80));
+        delta >>= 7;
+    }
+    buffer.push_back(static_cast<char>(delta));
+
+    if (buffer.size() >= IO_BUFFER_SIZE - 16)
+        flush();
+}
+
+void Frontier::LayerWriter::close()
+{
+    flush();
+    file.close();
+}
+
+Frontier::LayerReader::LayerReader(const std::string &path)
+    : file(path, std::ios::binary), buffer(IO_BUFFER_SIZE)
+{
+    if (!file)
+        throw std::runtime_error("Failed to open " + path);
+}
+
+bool Frontier::LayerReader::fill()
+{
+    file.read(buffer.data(), buffer.size());
+    length = file.gcount();
+    position = 0;
+
+    return length > 0;
+}
+
+bool Frontier::LayerReader::read(std::uint64_t &rank)
+{
+    std::uint64_t delta{0};
+
+    for (int shift{0};; shift += 7)
+    {
+        if (position == length && !fill())
+        {
+            if (shift > 0)
+                throw std::runtime_error("Truncated layer file");
+            return false;
+        }
+
+        unsigned char byte = buffer[position++];
+        delta |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+            break;
+    }
+
+    last += delta;
+    rank = last;
+    return true;
+}
+
+Frontier::BreadthFirstSearch::BreadthFirstSearch(const Space &space, const std::string &dir, std::size_t threads, std::size_t memory)
+    : space(space), dir(dir), threads(threads),
+      bufferSize(std::max<std::size_t>((memory - std::min(memory, (threads + 1) * IO_BUFFER_SIZE)) / sizeof(std::uint64_t) / threads, 1024)),
+      fanIn(std::max<std::size_t>(memory / IO_BUFFER_SIZE, 5) - 3)
+{
+}
+
+std::string Frontier::BreadthFirstSearch::layerPath(unsigned int depth) const
+{
+    return dir + "/layer-" + std::to_string(depth) + ".bin";
+}
+
+std::string Frontier::BreadthFirstSearch::spill(std::vector<std::uint64_t> &buffer, unsigned int depth)
+{
+    std::sort(buffer.begin(), buffer.end());
+    buffer.erase(std::unique(buffer.begin(), buffer.end()), buffer.end());
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        path = dir + "/run-" + std::to_string(depth) + "-" + std::to_string(runs.size()) + ".bin";
+        runs.push_back(path);
+    }
+
+    LayerWriter writer{path};
+    for (std::uint64_t rank : buffer)
+        writer.write(rank);
+    writer.close();
+
+    buffer.clear();
+    return path;
+}
+
+void Frontier::BreadthFirstSearch::expand(unsigned int depth)
+{
+    LayerReader layer{layerPath(depth)};
+    std::mutex readerMutex{};
+    std::exception_ptr error{};
+
+    auto worker = [&]()
+    {
+        try
+        {
+            std::vector<std::uint64_t> batch{};
+            std::vector<std::uint64_t> buffer{};
+            buffer.reserve(bufferSize);
+
+            std::vector<int> positions(space.items());
+            std::vector<int> occupant(space.cells());
+
+            while (true)
+            {
+                batch.clear();
+                {
+                    std::lock_guard<std::mutex> lock{readerMutex};
+                    std::uint64_t rank;
+                    while (batch.size() < BATCH_SIZE && layer.read(rank))
+                        batch.push_back(rank);
+                }
+                if (batch.empty())
+                    break;
+
+                for (std::uint64_t rank : batch)
+                {
+                    // Leave room for the successors of one state
+                    if (buffer.size() + 4 > bufferSize)
+                        spill(buffer, depth + 1);
+
+                    space.expand(rank, positions, occupant, buffer);
+                }
+            }
+
+            if (!buffer.empty())
+                spill(buffer, depth + 1);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock{readerMutex};
+            error = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> pool{};
+    for (std::size_t n{0}; n < threads; n++)
+        pool.emplace_back(worker);
+    for (std::thread &thread : pool)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void Frontier::BreadthFirstSearch::mergeRuns(const std::vector<std::string> &paths, LayerWriter &out, const std::vector<std::string> &previousPaths)
+{
+    std::vector<std::unique_ptr<LayerReader>> readers{};
+    using Head = std::pair<std::uint64_t, std::size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads{};
+
+    for (const std::string &path : paths)
+    {
+        readers.push_back(std::make_unique<LayerReader>(path));
+
+        std::uint64_t rank;
+        if (readers.back()->read(rank))
+            heads.emplace(rank, readers.size() - 1);
+    }
+
+    std::vector<std::unique_ptr<LayerReader>> previous{};
+    std::vector<std::uint64_t> previousHeads{};
+    std::vector<bool> previousDone{};
+    for (const std::string &path : previousPaths)
+    {
+        previous.push_back(std::make_unique<LayerReader>(path));
+        previousHeads.push_back(0);
+        previousDone.push_back(!previous.back()->read(previousHeads.back()));
+    }
+
+    bool first{true};
+    std::uint64_t last{0};
+    while (!heads.empty())
+    {
+        auto [rank, source] = heads.top();
+        heads.pop();
+
+        std::uint64_t following;
+        if (readers[source]->read(following))
+            heads.emplace(following, source);
+
+        if (!first && rank == last)
+            continue;
+        first = false;
+        last = rank;
+
+        bool seen{false};
+        for (std::size_t n{0}; n < previous.size(); n++)
+        {
+            while (!previousDone[n] && previousHeads[n] < rank)
+                previousDone[n] = !previous[n]->read(previousHeads[n]);
+
+            if (!previousDone[n] && previousHeads[n] == rank)
+                seen = true;
+        }
+
+        if (!seen)
+            out.write(rank);
+    }
+}
+
+std::uint64_t Frontier::BreadthFirstSearch::merge(unsigned int depth)
+{
+    // Merge groups of runs into longer ones until all are few enough for a single pass
+    for (unsigned int pass{0}; runs.size() > fanIn; pass++)
+    {
+        std::vector<std::string> merged{};
+        for (std::size_t start{0}; start < runs.size(); start += fanIn)
+        {
+            std::vector<std::string> group(runs.begin() + start, runs.begin() + std::min(start + fanIn, runs.size()));
+            if (group.size() == 1)
+            {
+                merged.push_back(group[0]);
+                continue;
+            }
+
+            std::string path{dir + "/merge-" + std::to_string(depth + 1) + "-" + std::to_string(pass) + "-" + std::to_string(merged.size()) + ".bin"};
+            LayerWriter writer{path};
+            mergeRuns(group, writer, {});
+            writer.close();
+
+            for (const std::string &run : group)
+                std::remove(run.c_str());
+            merged.push_back(path);
+        }
+
+        runs = std::move(merged);
+    }
+
+    // Frontier search in an undirected graph only needs the last two layers to detect duplicates
+    std::vector<std::string> previous{layerPath(depth)};
+    if (depth > 0)
+        previous.push_back(layerPath(depth - 1));
+
+    LayerWriter next{layerPath(depth + 1)};
+    mergeRuns(runs, next, previous);
+    next.close();
+
+    for (const std::string &path : runs)
+        std::remove(path.c_str());
+    runs.clear();
+
+    return next.size();
+}
+
+std::vector<std::uint64_t> Frontier::BreadthFirstSearch::run(bool keep, const Progress &progress)
+{
+    std::vector<std::uint64_t> counts{};
+
+    LayerWriter first{layerPath(0)};
+    first.write(space.goal());
+    first.close();
+    counts.push_back(1);
+
+    for (unsigned int depth{0};; depth++)
+    {
+        expand(depth);
+        std::uint64_t count{merge(depth)};
+
+        // The layer before the current one is not needed anymore
+        if (!keep && depth > 0)
+            std::remove(layerPath(depth - 1).c_str());
+
+        if (count == 0)
+        {
+            std::remove(layerPath(depth + 1).c_str());
+            break;
+        }
+
+        counts.push_back(count);
+        if (progress)
+            progress(depth + 1, count);
+    }
+
+    return counts;
+}
+
+std::vector<std::uint64_t> Frontier::BreadthFirstSearch::hardest(unsigned int depth, std::size_t count)
+{
+    std::vector<std::uint64_t> ranks{};
+
+    LayerReader layer{layerPath(depth)};
+    std::uint64_t rank;
+    while (ranks.size() < count && layer.read(rank))
+        ranks.push_back(rank);
+
+    return ranks;
+}
+
+void Frontier::BreadthFirstSearch::cleanup(unsigned int depth)
+{
+    std::remove(layerPath(depth).c_str());
+    if (depth > 0)
+        std::remove(layerPath(depth - 1).c_str());
+}
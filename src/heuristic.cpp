@@ -1,6 +1,44 @@
 #include "heuristic.h"
 
+#include <array>
 #include <cmath>
+#include <algorithm>
+#include <mutex>
+
+static unsigned int manhattanDistance(int from, int to, int dimension)
+{
+    return std::abs((from / dimension) - (to / dimension)) +
+           std::abs((from % dimension) - (to % dimension));
+}
+
+// Tile of the dual at the goal position of a tile of p, the blank for the blank's goal position
+static int dualTile(int index, int last)
+{
+    return index == last ? 0 : index + 1;
+}
+
+// Fewest of count goal positions to remove for the rest to be in increasing order, which is the
+// count less the longest increasing subsequence. tails holds room for count values.
+static unsigned int minimumRemovals(const int *goals, int count, int *tails)
+{
+    // Smallest last element of an increasing subsequence of each length
+    int length{0};
+    for (int i{0}; i < count; i++)
+    {
+        int *it{std::lower_bound(tails, tails + length, goals[i])};
+        if (it == tails + length)
+            length++;
+        *it = goals[i];
+    }
+
+    return count - length;
+}
+
+static unsigned int minimumRemovals(const std::vector<int> &goals)
+{
+    std::vector<int> tails(goals.size());
+    return minimumRemovals(goals.data(), goals.size(), tails.data());
+}
 
 unsigned int Heuristic::ManhattanDistanceHeuristic::operator()(const Puzzle &p) const
 {
@@ -18,73 +56,170 @@ unsigned int Heuristic::ManhattanDistanceHeuristic::operator()(const Puzzle &p)
             continue; // Skip if placed correctly
 
         // Manhattan distance of current tile's position and the expected position
-        distance += std::abs((realValue / dimension) - (n / dimension)) +
-                    std::abs((realValue % dimension) - (n % dimension));
+        distance += manhattanDistance(n, realValue, dimension);
     }
 
     return distance;
 }
 
+unsigned int Heuristic::ManhattanDistanceHeuristic::update(const Puzzle &p, unsigned int h, Puzzle::Move move) const
+{
+    // Only the moved tile changed its distance, it came from the current blank position
+    int to{p.movedTileIndex(move)};
+    int goal{p.get(to) - 1};
+
+    return h - manhattanDistance(p.getBlank(), goal, p.getDimension()) + manhattanDistance(to, goal, p.getDimension());
+}
+
 unsigned int Heuristic::LinearConflictHeuristic::operator()(const Puzzle &p) const
 {
     unsigned int conflicts{0};
 
     int dimension{p.getDimension()};
 
+    // Goal columns of the tiles of a row that belong to it, or goal rows for a column.
+    // Counting every reversed pair instead would overestimate lines with three or more
+    // tiles out of order, only the fewest tiles leaving the line make it admissible.
+    std::vector<int> rowGoals{}, columnGoals{};
+
     // For each row and column
     for (int i{0}; i < dimension; i++)
     {
-        // Calculate conflicts in row
-        for (int k{0}, l{dimension - 1}; k < l; k++)
-        {
-            int kVal = p.get(i, k);
-            if (kVal == 0)
-                continue;
+        rowGoals.clear();
+        columnGoals.clear();
 
-            int kGoalRow{(kVal - 1) / dimension}, kGoalCol{(kVal - 1) % dimension};
-            // Tj is to the right of Tk
-            for (int j{k + 1}; j < dimension; j++)
-            {
-                int jVal = p.get(i, j);
-                if (jVal == 0)
-                    continue;
-
-                int jGoalRow{(jVal - 1) / dimension}, jGoalCol{(jVal - 1) % dimension};
-                // Goal position of both Tj and Tk must be on the same line
-                if (jGoalRow != i || kGoalRow != i)
-                    continue;
-                // If goal position of Tj is to the left of Tk then there's a linear conflict
-                if (jGoalCol < kGoalCol)
-                    conflicts++;
-            }
-        }
-        // Calculate conflicts in columns
-        for (int k{0}, l{dimension - 1}; k < l; k++)
+        for (int k{0}; k < dimension; k++)
         {
-            int kVal = p.get(k, i);
-            if (kVal == 0)
-                continue;
+            // Tiles in row whose goal position is on the same row
+            int rowVal{p.get(i, k)};
+            if (rowVal != 0 && (rowVal - 1) / dimension == i)
+                rowGoals.push_back((rowVal - 1) % dimension);
 
-            int kGoalRow{(kVal - 1) / dimension}, kGoalCol{(kVal - 1) % dimension};
-            for (int j{k + 1}; j < dimension; j++)
-            {
-                int jVal = p.get(j, i);
-                if (jVal == 0)
-                    continue;
-
-                int jGoalRow{(jVal - 1) / dimension}, jGoalCol{(jVal - 1) % dimension};
-                if (jGoalCol != i || kGoalCol != i)
-                    continue;
-                if (jGoalRow < kGoalRow)
-                    conflicts++;
-            }
+            // Tiles in column whose goal position is on the same column
+            int columnVal{p.get(k, i)};
+            if (columnVal != 0 && (columnVal - 1) % dimension == i)
+                columnGoals.push_back((columnVal - 1) / dimension);
         }
+
+        conflicts += minimumRemovals(rowGoals) + minimumRemovals(columnGoals);
     }
 
     ManhattanDistanceHeuristic md{};
     return (conflicts * 2) + md(p);
 }
 
+const std::vector<unsigned char> &Heuristic::LinearConflictTableHeuristic::table(int dimension)
+{
+    static std::array<std::once_flag, TABLE_MAX_DIMENSION + 1> built{};
+    static std::array<std::vector<unsigned char>, TABLE_MAX_DIMENSION + 1> tables{};
+
+    std::call_once(built[dimension], [dimension]()
+                   {
+                       // A key holds a digit per cell of the line, first cell in the highest digit
+                       int base{dimension + 1};
+                       std::size_t size{1};
+                       for (int i{0}; i < dimension; i++)
+                           size *= base;
+
+                       std::vector<unsigned char> &conflicts{tables[dimension]};
+                       conflicts.resize(size);
+
+                       std::vector<int> digits(dimension), goals{};
+                       for (std::size_t key{0}; key < size; key++)
+                       {
+                           std::size_t rest{key};
+                           for (int i{dimension - 1}; i >= 0; i--)
+                           {
+                               digits[i] = rest % base;
+                               rest /= base;
+                           }
+
+                           goals.clear();
+                           for (int digit : digits)
+                           {
+                               if (digit < dimension)
+                                   goals.push_back(digit);
+                           }
+
+                           conflicts[key] = minimumRemovals(goals);
+                       } });
+
+    return tables[dimension];
+}
+
+unsigned int Heuristic::LinearConflictTableHeuristic::lineConflicts(const Puzzle &p, int line, bool column, int swapA, int swapB)
+{
+    int dimension{p.getDimension()};
+    bool tabled{dimension <= TABLE_MAX_DIMENSION};
+
+    std::size_t key{0};
+
+    // Goal positions of the tiles belonging to the line and the room to find their conflicts,
+    // on the heap only for boards too large to ever be solved
+    std::array<int, 2 * DIRECT_MAX_DIMENSION> local;
+    std::vector<int> allocated{};
+    if (!tabled && dimension > DIRECT_MAX_DIMENSION)
+        allocated.resize(2 * dimension);
+    int *goals{allocated.empty() ? local.data() : allocated.data()};
+    int count{0};
+
+    for (int i{0}; i < dimension; i++)
+    {
+        int n{column ? (i * dimension) + line : (line * dimension) + i};
+        if (n == swapA)
+            n = swapB;
+        else if (n == swapB)
+            n = swapA;
+
+        // Position along the line the tile belongs at, or dimension if it belongs to another line
+        int value{p.get(n)};
+        int goal{value - 1};
+        int digit{dimension};
+        if (value != 0 && (column ? goal % dimension : goal / dimension) == line)
+            digit = column ? goal / dimension : goal % dimension;
+
+        if (tabled)
+            key = (key * (dimension + 1)) + digit;
+        else if (digit < dimension)
+            goals[count++] = digit;
+    }
+
+    return tabled ? table(dimension)[key] : minimumRemovals(goals, count, goals + dimension);
+}
+
+unsigned int Heuristic::LinearConflictTableHeuristic::operator()(const Puzzle &p) const
+{
+    unsigned int conflicts{0};
+
+    for (int i{0}; i < p.getDimension(); i++)
+        conflicts += lineConflicts(p, i, false, -1, -1) + lineConflicts(p, i, true, -1, -1);
+
+    ManhattanDistanceHeuristic md{};
+    return (conflicts * 2) + md(p);
+}
+
+unsigned int Heuristic::LinearConflictTableHeuristic::update(const Puzzle &p, unsigned int h, Puzzle::Move move) const
+{
+    int dimension{p.getDimension()};
+    int from{p.getBlank()}, to{p.movedTileIndex(move)};
+
+    ManhattanDistanceHeuristic md{};
+    int value = md.update(p, h, move);
+
+    // The moved tile left one line and entered another across its move, and moved along a third
+    bool vertical{move == Puzzle::Move::UP || move == Puzzle::Move::DOWN};
+    std::array<std::pair<int, bool>, 3> lines{{
+        {vertical ? from / dimension : from % dimension, !vertical},
+        {vertical ? to / dimension : to % dimension, !vertical},
+        {vertical ? to % dimension : to / dimension, vertical},
+    }};
+
+    for (const auto &[line, column] : lines)
+        value += 2 * (static_cast<int>(lineConflicts(p, line, column, -1, -1)) - static_cast<int>(lineConflicts(p, line, column, from, to)));
+
+    return value;
+}
+
 unsigned int Heuristic::MisplacedTilesHeuristic::operator()(const Puzzle &p) const
 {
     unsigned int misplaced{0};
@@ -101,4 +236,177 @@ unsigned int Heuristic::MisplacedTilesHeuristic::operator()(const Puzzle &p) con
     }
 
     return misplaced;
-}
\ No newline at end of file
+}
+
+unsigned int Heuristic::MisplacedTilesHeuristic::update(const Puzzle &p, unsigned int h, Puzzle::Move move) const
+{
+    int to{p.movedTileIndex(move)};
+    int goal{p.get(to) - 1};
+
+    return h - (p.getBlank() != goal) + (to != goal);
+}
+
+Heuristic::ReflectionDualHeuristic::ReflectionDualHeuristic(std::shared_ptr<const Puzzle::Heuristic> heuristic)
+    : heuristic(heuristic)
+{
+}
+
+unsigned int Heuristic::ReflectionDualHeuristic::operator()(const Puzzle &p) const
+{
+    Puzzle reflected{p};
+    reflect(p, reflected);
+
+    // The dual is only an admissible estimate when the blank is at its goal position
+    unsigned int dualH{0};
+    if (p.getBlank() == p.getSize())
+    {
+        Puzzle dual{p};
+        dualize(p, dual);
+        dualH = (*heuristic)(dual);
+    }
+
+    return std::max({(*heuristic)(p), (*heuristic)(reflected), dualH});
+}
+
+std::unique_ptr<const Puzzle::Heuristic> Heuristic::ReflectionDualHeuristic::forSearch() const
+{
+    return std::make_unique<Tracker>(heuristic);
+}
+
+Heuristic::ReflectionDualHeuristic::Tracker::Tracker(std::shared_ptr<const Puzzle::Heuristic> heuristic)
+    : heuristic(heuristic)
+{
+}
+
+unsigned int Heuristic::ReflectionDualHeuristic::Tracker::operator()(const Puzzle &p) const
+{
+    if (board == nullptr || board->getDimension() != p.getDimension())
+    {
+        board = std::make_unique<Puzzle>(p);
+        reflected = std::make_unique<Puzzle>(p);
+        dual = std::make_unique<Puzzle>(p);
+    }
+
+    // Start a new path from this state
+    *board = p;
+    reflect(p, *reflected);
+    dualize(p, *dual);
+
+    Entry entry{Puzzle::Move::UP, (*heuristic)(p), (*heuristic)(*reflected)};
+    path.clear();
+    path.push_back(entry);
+
+    return evaluate(entry);
+}
+
+unsigned int Heuristic::ReflectionDualHeuristic::Tracker::update(const Puzzle &p, unsigned int h, Puzzle::Move move) const
+{
+    if (board == nullptr || board->getDimension() != p.getDimension())
+        return (*this)(p);
+
+    // Find the parent of p on the path, undoing the moves the search backtracked over
+    while (true)
+    {
+        if (follow(move))
+        {
+            if (board->getHash() == p.getHash())
+            {
+                const Entry &parent{path.back()};
+                Entry entry{move, heuristic->update(p, parent.h, move), heuristic->update(*reflected, parent.reflectedH, reflect(move))};
+                path.push_back(entry);
+
+                return evaluate(entry);
+            }
+
+            follow(Puzzle::inverse(move));
+        }
+
+        if (path.size() <= 1)
+            break;
+
+        follow(Puzzle::inverse(path.back().move));
+        path.pop_back();
+    }
+
+    // Not reached from any state on the path, evaluate from scratch
+    return (*this)(p);
+}
+
+bool Heuristic::ReflectionDualHeuristic::Tracker::follow(Puzzle::Move move) const
+{
+    if (!board->move(move))
+        return false;
+
+    reflected->move(reflect(move));
+    dualize(*board, move, *dual);
+
+    return true;
+}
+
+unsigned int Heuristic::ReflectionDualHeuristic::Tracker::evaluate(const Entry &entry) const
+{
+    unsigned int dualH{0};
+    if (board->getBlank() == board->getSize())
+        dualH = (*heuristic)(*dual);
+
+    return std::max({entry.h, entry.reflectedH, dualH});
+}
+
+Puzzle::Move Heuristic::ReflectionDualHeuristic::reflect(Puzzle::Move move)
+{
+    // Moving along a column becomes moving along a row
+    switch (move)
+    {
+    case Puzzle::Move::UP:
+        return Puzzle::Move::LEFT;
+    case Puzzle::Move::DOWN:
+        return Puzzle::Move::RIGHT;
+    case Puzzle::Move::LEFT:
+        return Puzzle::Move::UP;
+    case Puzzle::Move::RIGHT:
+    default:
+        return Puzzle::Move::DOWN;
+    }
+}
+
+void Heuristic::ReflectionDualHeuristic::reflect(const Puzzle &p, Puzzle &reflection)
+{
+    int dimension{p.getDimension()};
+    int blank{p.getBlank()};
+
+    // Move the blank first so that every other tile can be written directly
+    reflection.set(((blank % dimension) * dimension) + (blank / dimension), 0);
+
+    for (int n{0}, len{dimension * dimension}; n < len; n++)
+    {
+        int value{p.get(n)};
+        if (value == 0)
+            continue;
+
+        // Tile goes to the transposed position and is relabeled after its transposed goal
+        int goal{value - 1};
+        reflection.put(n % dimension, n / dimension, ((goal % dimension) * dimension) + (goal / dimension) + 1);
+    }
+}
+
+void Heuristic::ReflectionDualHeuristic::dualize(const Puzzle &p, Puzzle &dual)
+{
+    int last{p.getSize()};
+
+    // Swap the roles of tiles and positions: tile at goal position of v is v's current position
+    for (int n{0}; n <= last; n++)
+    {
+        int value{p.get(n)};
+        dual.put(value == 0 ? last : value - 1, dualTile(n, last));
+    }
+}
+
+void Heuristic::ReflectionDualHeuristic::dualize(const Puzzle &p, Puzzle::Move move, Puzzle &dual)
+{
+    int last{p.getSize()};
+    int to{p.movedTileIndex(move)};
+
+    // Only the moved tile and the blank changed position
+    dual.put(p.get(to) - 1, dualTile(to, last));
+    dual.put(last, dualTile(p.getBlank(), last));
+}
@@ -0,0 +1,196 @@
+#include "optimizer.h"
+
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+#include "search.h"
+
+Search::PathOptimizer::PathOptimizer(std::shared_ptr<const Puzzle::Heuristic> heuristic)
+    : PathOptimizer(heuristic, Options{})
+{
+}
+
+Search::PathOptimizer::PathOptimizer(std::shared_ptr<const Puzzle::Heuristic> heuristic, const Options &options)
+    : heuristic(heuristic), options(options)
+{
+}
+
+std::vector<Puzzle::Move> Search::PathOptimizer::removeCycles(const Puzzle &start, const std::vector<Puzzle::Move> &moves)
+{
+    Puzzle board{start};
+
+    std::vector<Puzzle::Move> path{};
+    // State after each prefix of path, and the prefix length by state
+    std::vector<Puzzle> states{board};
+    std::unordered_map<Puzzle, std::size_t> seen{{board, 0}};
+
+    for (Puzzle::Move move : moves)
+    {
+        if (!board.move(move))
+            continue;
+
+        path.push_back(move);
+
+        auto [it, inserted]{seen.emplace(board, path.size())};
+        if (inserted)
+        {
+            states.push_back(board);
+            continue;
+        }
+
+        // Back at an earlier state, forget everything after it
+        std::size_t length{it->second};
+        for (std::size_t n{length + 1}; n < states.size(); n++)
+            seen.erase(states[n]);
+
+        states.erase(states.begin() + length + 1, states.end());
+        path.resize(length);
+    }
+
+    return path;
+}
+
+std::vector<Puzzle::Move> Search::PathOptimizer::connect(const Puzzle &from, const Puzzle &to, unsigned int maxLength,
+                                                         std::chrono::steady_clock::time_point deadline, std::atomic<bool> &running,
+                                                         Puzzle::Stats &stats) const
+{
+    int cells{from.getDimension() * from.getDimension()};
+
+    // Relabel every tile after its position in to, which the heuristic then takes for the goal.
+    // Unless the blank of to is in the last cell, the tile going there gets the label cells and
+    // the board is no permutation, which only heuristics reading goals off labels can value.
+    std::vector<int> position(cells);
+    for (int n{0}; n < cells; n++)
+        position[to.get(n)] = n;
+
+    Puzzle relabeled{from};
+    for (int n{0}; n < cells; n++)
+    {
+        if (from.get(n) != 0)
+            relabeled.put(n, position[from.get(n)] + 1);
+    }
+
+    Puzzle::Options searchOptions{};
+    searchOptions.maxDepth = maxLength;
+    searchOptions.deadline = deadline;
+
+    IDAStarSearch search{relabeled, *heuristic, searchOptions};
+    return search.run(running, stats);
+}
+
+Search::PathOptimizer::Result Search::PathOptimizer::run(const Puzzle &start, const std::vector<Puzzle::Move> &moves, std::atomic<bool> &running) const
+{
+    auto deadline{options.budget.count() > 0 ? std::chrono::steady_clock::now() + options.budget
+                                              : std::chrono::steady_clock::time_point::max()};
+    unsigned int window{std::max(options.window, 2u)};
+    unsigned int threadCount{options.threads > 0 ? options.threads : std::max(std::thread::hardware_concurrency(), 1u)};
+
+    Result result{};
+    result.moves = removeCycles(start, moves);
+    result.cycleMoves = moves.size() - result.moves.size();
+
+    // Passes in a row that gained nothing, one more than that and both offsets are exhausted
+    unsigned int idle{0};
+    for (unsigned int offset{0}; idle < 2; offset = offset == 0 ? window / 2 : 0)
+    {
+        if (!running.load() || std::chrono::steady_clock::now() >= deadline)
+            break;
+
+        const std::vector<Puzzle::Move> &path{result.moves};
+
+        // Window n spans the moves from borders[n] to borders[n + 1], with the states there
+        std::vector<std::size_t> borders{0};
+        for (std::size_t border{offset > 0 ? offset : window}; border < path.size(); border += window)
+            borders.push_back(border);
+        borders.push_back(path.size());
+
+        std::vector<Puzzle> states{start};
+        Puzzle board{start};
+        for (std::size_t n{0}, next{1}; n < path.size(); n++)
+        {
+            board.move(path[n]);
+            if (n + 1 == borders[next])
+            {
+                states.push_back(board);
+                next++;
+            }
+        }
+
+        std::size_t windows{borders.size() - 1};
+        std::vector<std::vector<Puzzle::Move>> replacements(windows);
+        // Written by several threads at once, so not a vector<bool>
+        std::vector<char> replaced(windows, false);
+
+        std::atomic<std::size_t> nextWindow{0};
+        std::atomic<unsigned long long> nodes{0};
+
+        auto work{[&]()
+                  {
+                      for (std::size_t n{nextWindow++}; n < windows; n = nextWindow++)
+                      {
+                          // Paths between two states have the same parity, a shorter one is two moves shorter
+                          std::size_t length{borders[n + 1] - borders[n]};
+                          if (length < 3)
+                              continue;
+
+                          const Puzzle &to{states[n + 1]};
+                          if (!heuristic->labelGoals() && to.getBlank() != (to.getDimension() * to.getDimension()) - 1)
+                              continue;
+
+                          Puzzle::Stats stats{};
+                          try
+                          {
+                              replacements[n] = connect(states[n], states[n + 1], length - 2, deadline, running, stats);
+                              replaced[n] = true;
+                          }
+                          catch (Puzzle::MaxThresholdException &)
+                          {
+                              // Already optimal
+                          }
+                          catch (Puzzle::DeadlineException &)
+                          {
+                          }
+                          catch (Puzzle::CancelledException &)
+                          {
+                          }
+                          nodes += stats.nodes;
+                      }
+                  }};
+
+        std::vector<std::thread> threads{};
+        for (unsigned int n{1}; n < std::min<std::size_t>(threadCount, windows); n++)
+            threads.emplace_back(work);
+        work();
+        for (std::thread &thread : threads)
+            thread.join();
+
+        result.nodes += nodes;
+        result.passes++;
+
+        std::vector<Puzzle::Move> shortened{};
+        for (std::size_t n{0}; n < windows; n++)
+        {
+            if (replaced[n])
+                shortened.insert(shortened.end(), replacements[n].begin(), replacements[n].end());
+            else
+                shortened.insert(shortened.end(), path.begin() + borders[n], path.begin() + borders[n + 1]);
+        }
+
+        if (shortened.size() == path.size())
+        {
+            idle++;
+            continue;
+        }
+        idle = 0;
+
+        result.windowMoves += path.size() - shortened.size();
+
+        // New segments may revisit states of their neighbours
+        std::vector<Puzzle::Move> acyclic{removeCycles(start, shortened)};
+        result.cycleMoves += shortened.size() - acyclic.size();
+        result.moves = std::move(acyclic);
+    }
+
+    return result;
+}
@@ -0,0 +1,162 @@
+#include "portfolio.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+#include "heuristic.h"
+#include "search.h"
+
+const std::chrono::milliseconds Search::PortfolioSearch::POLL_INTERVAL{1};
+
+std::vector<Search::PortfolioSearch::Config> Search::PortfolioSearch::defaultConfigs()
+{
+    Puzzle::Options controlled{};
+    controlled.threshold = Puzzle::Threshold::CONTROLLED;
+
+    Puzzle::Options reversed{};
+    reversed.order = {Puzzle::Move::RIGHT, Puzzle::Move::LEFT, Puzzle::Move::DOWN, Puzzle::Move::UP};
+
+    return {
+        {"linear-conflict", std::make_shared<Heuristic::LinearConflictTableHeuristic>()},
+        {"linear-conflict-cr", std::make_shared<Heuristic::LinearConflictTableHeuristic>(), controlled},
+        {"linear-conflict-reversed", std::make_shared<Heuristic::LinearConflictTableHeuristic>(), reversed},
+        {"linear-conflict-reflected", std::make_shared<Heuristic::ReflectionDualHeuristic>(std::make_shared<Heuristic::LinearConflictTableHeuristic>())},
+        {"manhattan-cr", std::make_shared<Heuristic::ManhattanDistanceHeuristic>(), controlled},
+    };
+}
+
+Search::PortfolioSearch::PortfolioSearch(std::vector<Config> configs)
+    : configs(std::move(configs)), wins(this->configs.size())
+{
+}
+
+Search::PortfolioSearch::Result Search::PortfolioSearch::run(const Puzzle &puzzle, std::atomic<bool> &running)
+{
+    if (!puzzle.isSolvable())
+        throw Puzzle::UnsolvableException();
+
+    auto startTime{std::chrono::steady_clock::now()};
+
+    // Shared by all searches, cleared by the winner to cancel the rest
+    std::atomic<bool> racing{true};
+
+    std::mutex mutex{};
+    std::condition_variable finished{};
+    std::size_t done{0};
+    bool found{false};
+    Result result{};
+    std::exception_ptr error{};
+
+    std::vector<std::thread> threads{};
+    for (std::size_t n{0}; n < configs.size(); n++)
+    {
+        threads.emplace_back([&, n]()
+                             {
+            Puzzle::Stats stats{};
+            std::vector<Puzzle::Move> moves{};
+            std::exception_ptr failure{};
+            bool solved{false};
+
+            try
+            {
+                IDAStarSearch search{puzzle, *configs[n].heuristic, configs[n].options};
+                moves = search.run(racing, stats);
+                solved = true;
+            }
+            catch (Puzzle::CancelledException &)
+            {
+            }
+            catch (...)
+            {
+                failure = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock{mutex};
+
+            done++;
+            result.totalNodes += stats.nodes;
+
+            if (failure && !error)
+                error = failure;
+
+            if (solved && !found)
+            {
+                found = true;
+                racing = false;
+
+                result.moves = std::move(moves);
+                result.winner = n;
+                result.stats = stats;
+            }
+
+            finished.notify_one(); });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        while (!found && done < threads.size())
+        {
+            if (!running.load(std::memory_order_relaxed))
+                racing = false;
+
+            finished.wait_for(lock, POLL_INTERVAL);
+        }
+    }
+
+    racing = false;
+    for (std::thread &thread : threads)
+        thread.join();
+
+    if (!found)
+    {
+        if (error && running)
+            std::rethrow_exception(error);
+
+        throw Puzzle::CancelledException();
+    }
+
+    wins[result.winner]++;
+    result.elapsed = std::chrono::steady_clock::now() - startTime;
+
+    return result;
+}
+
+void Search::PortfolioSearch::prune(std::size_t count)
+{
+    if (count >= configs.size())
+        return;
+
+    // Most wins first, earlier configurations first among equals
+    std::vector<std::size_t> ranking(configs.size());
+    std::iota(ranking.begin(), ranking.end(), 0);
+    std::stable_sort(ranking.begin(), ranking.end(), [&](std::size_t a, std::size_t b)
+                     { return wins[a] > wins[b]; });
+
+    ranking.resize(count);
+    std::sort(ranking.begin(), ranking.end());
+
+    std::vector<Config> keptConfigs{};
+    std::vector<unsigned int> keptWins{};
+    for (std::size_t n : ranking)
+    {
+        keptConfigs.push_back(std::move(configs[n]));
+        keptWins.push_back(wins[n]);
+    }
+
+    configs = std::move(keptConfigs);
+    wins = std::move(keptWins);
+}
+
+const std::vector<Search::PortfolioSearch::Config> &Search::PortfolioSearch::getConfigs() const
+{
+    return configs;
+}
+
+const std::vector<unsigned int> &Search::PortfolioSearch::getWins() const
+{
+    return wins;
+}
@@ -1,10 +1,11 @@
 #include <algorithm>
+#include <cmath>
 #include <vector>
-#include <deque>
-#include <limits>
 #include <random>
+#include <sstream>
 
 #include "puzzle.h"
+#include "search.h"
 
 Puzzle::Puzzle(int size)
 {
@@ -23,6 +24,8 @@ Puzzle::Puzzle(int size)
     blankRow = dimension - 1;
     blankCol = dimension - 1;
 
+    rehash();
+
     // Make random moves
     shuffle();
 }
@@ -33,6 +36,7 @@ Puzzle::Puzzle(const Puzzle &p)
 
     blankRow = p.blankRow;
     blankCol = p.blankCol;
+    hash = p.hash;
 
     tiles = new int[dimension * dimension];
     std::copy(p.tiles, p.tiles + (dimension * dimension), tiles);
@@ -44,6 +48,7 @@ Puzzle::Puzzle(Puzzle &&p)
 
     blankRow = p.blankRow;
     blankCol = p.blankCol;
+    hash = p.hash;
 
     tiles = p.tiles;
     p.tiles = nullptr;
@@ -55,6 +60,32 @@ Puzzle::~Puzzle()
         delete[] tiles;
 }
 
+std::uint64_t Puzzle::zobrist(int index, int value)
+{
+    if (value == 0)
+        return 0;
+
+    // Keys are mixed from the cell and tile rather than drawn into a table,
+    // so boards of any size get them without a table per dimension
+    std::uint64_t key{(static_cast<std::uint64_t>(index) << 32) | static_cast<std::uint32_t>(value)};
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+
+    return key;
+}
+
+void Puzzle::rehash()
+{
+    hash = 0;
+
+    int len{dimension * dimension};
+    for (int i{0}; i < len; i++)
+        hash ^= zobrist(i, tiles[i]);
+}
+
 int &Puzzle::at(int row, int col)
 {
     return tiles[(row * dimension) + col];
@@ -65,7 +96,8 @@ bool Puzzle::operator==(const Puzzle &p) const
     if (dimension != p.dimension)
         return false;
 
-    if (blankRow != p.blankRow || blankCol != p.blankCol)
+    // Different hashes always mean different boards
+    if (hash != p.hash || blankRow != p.blankRow || blankCol != p.blankCol)
         return false;
 
     return std::equal(tiles, tiles + (dimension * dimension), p.tiles);
@@ -73,10 +105,18 @@ bool Puzzle::operator==(const Puzzle &p) const
 
 Puzzle &Puzzle::operator=(const Puzzle &p)
 {
+    // Boards of another size need a differently sized tile array
+    if (dimension != p.dimension || tiles == nullptr)
+    {
+        delete[] tiles;
+        tiles = new int[p.dimension * p.dimension];
+    }
+
     dimension = p.dimension;
 
     blankRow = p.blankRow;
     blankCol = p.blankCol;
+    hash = p.hash;
 
     std::copy(p.tiles, p.tiles + (dimension * dimension), tiles);
 
@@ -89,8 +129,9 @@ Puzzle &Puzzle::operator=(Puzzle &&p)
 
     blankRow = p.blankRow;
     blankCol = p.blankCol;
+    hash = p.hash;
 
-    delete tiles;
+    delete[] tiles;
     tiles = p.tiles;
     p.tiles = nullptr;
 
@@ -109,39 +150,69 @@ int Puzzle::getSize() const
 
 bool Puzzle::move(Move move)
 {
+    int row{blankRow}, col{blankCol};
+
     switch (move)
     {
     case UP:
         if (blankRow == 0)
             return false;
-
-        std::swap(at(blankRow, blankCol), at(blankRow - 1, blankCol));
-        blankRow--;
-        return true;
+        row--;
+        break;
     case DOWN:
         if (blankRow == dimension - 1)
             return false;
-
-        std::swap(at(blankRow, blankCol), at(blankRow + 1, blankCol));
-        blankRow++;
-        return true;
+        row++;
+        break;
     case LEFT:
         if (blankCol == 0)
             return false;
-
-        std::swap(at(blankRow, blankCol), at(blankRow, blankCol - 1));
-        blankCol--;
-        return true;
+        col--;
+        break;
     case RIGHT:
         if (blankCol == dimension - 1)
             return false;
-
-        std::swap(at(blankRow, blankCol), at(blankRow, blankCol + 1));
-        blankCol++;
-        return true;
+        col++;
+        break;
     default:
         return false;
     }
+
+    // Only the moved tile changes cell
+    int &tile{at(row, col)};
+    hash ^= zobrist((row * dimension) + col, tile) ^ zobrist((blankRow * dimension) + blankCol, tile);
+
+    std::swap(at(blankRow, blankCol), tile);
+    blankRow = row;
+    blankCol = col;
+
+    return true;
+}
+
+const char Puzzle::MOVE_NAMES[4]{'U', 'D', 'L', 'R'};
+
+Puzzle::Move Puzzle::inverse(Move move)
+{
+    // Moves are declared in opposite pairs
+    return static_cast<Move>(move ^ 1);
+}
+
+int Puzzle::movedTileIndex(Move move) const
+{
+    int blank{getBlank()};
+
+    switch (move)
+    {
+    case Move::UP:
+        return blank + dimension;
+    case Move::DOWN:
+        return blank - dimension;
+    case Move::LEFT:
+        return blank + 1;
+    case Move::RIGHT:
+    default:
+        return blank - 1;
+    }
 }
 
 std::vector<Puzzle::Move> Puzzle::validMoves() const
@@ -175,21 +246,46 @@ void Puzzle::shuffle()
     }
 }
 
-int &Puzzle::get(int index) const
+int Puzzle::getBlank() const
+{
+    return (blankRow * dimension) + blankCol;
+}
+
+int Puzzle::get(int index) const
 {
     return tiles[index];
 }
 
-int &Puzzle::get(int row, int col) const
+int Puzzle::get(int row, int col) const
 {
     return get((row * dimension) + col);
 }
 
+void Puzzle::put(int index, int value)
+{
+    hash ^= zobrist(index, tiles[index]) ^ zobrist(index, value);
+    tiles[index] = value;
+
+    if (value == 0)
+    {
+        blankRow = index / dimension;
+        blankCol = index % dimension;
+    }
+}
+
+void Puzzle::put(int row, int col, int value)
+{
+    put((row * dimension) + col, value);
+}
+
 bool Puzzle::set(int index, int value)
 {
     if (value == 0)
     {
-        std::swap(tiles[index], at(blankRow, blankCol));
+        int blank{getBlank()};
+        hash ^= zobrist(index, tiles[index]) ^ zobrist(blank, tiles[index]);
+
+        std::swap(tiles[index], tiles[blank]);
         blankRow = index / dimension;
         blankCol = index % dimension;
     }
@@ -210,6 +306,8 @@ bool Puzzle::set(int index, int value)
         if (!found)
             return false;
 
+        hash ^= zobrist(index, tiles[index]) ^ zobrist(n, tiles[index]) ^ zobrist(n, value) ^ zobrist(index, value);
+
         std::swap(tiles[index], tiles[n]);
         if (tiles[n] == 0)
         {
@@ -226,6 +324,79 @@ bool Puzzle::set(int row, int col, int value)
     return set((row * dimension) + col, value);
 }
 
+bool Puzzle::setTiles(const std::vector<int> &tiles)
+{
+    int len = tiles.size();
+    int newDimension = std::lround(std::sqrt(len));
+    if (newDimension < 2 || newDimension * newDimension != len)
+        return false;
+
+    std::vector<bool> seen(len);
+    for (int tile : tiles)
+    {
+        if (tile < 0 || tile >= len || seen[tile])
+            return false;
+        seen[tile] = true;
+    }
+
+    if (newDimension != dimension)
+    {
+        delete[] this->tiles;
+        this->tiles = new int[len];
+        dimension = newDimension;
+    }
+
+    std::copy(tiles.begin(), tiles.end(), this->tiles);
+
+    int blank = std::find(tiles.begin(), tiles.end(), 0) - tiles.begin();
+    blankRow = blank / dimension;
+    blankCol = blank % dimension;
+
+    rehash();
+
+    return true;
+}
+
+bool Puzzle::parseTiles(const std::string &line)
+{
+    std::vector<int> tiles{};
+
+    std::istringstream stream{line};
+    int tile{};
+    while (stream >> tile)
+        tiles.push_back(tile);
+
+    return stream.eof() && setTiles(tiles);
+}
+
+std::uint64_t Puzzle::pack() const
+{
+    std::uint64_t packed{0};
+
+    int len{dimension * dimension};
+    for (int i{0}; i < len; i++)
+        packed |= static_cast<std::uint64_t>(tiles[i]) << (4 * i);
+
+    return packed;
+}
+
+void Puzzle::unpack(std::uint64_t packed)
+{
+    int len{dimension * dimension};
+    for (int i{0}; i < len; i++)
+    {
+        tiles[i] = (packed >> (4 * i)) & 0xF;
+
+        if (tiles[i] == 0)
+        {
+            blankRow = i / dimension;
+            blankCol = i % dimension;
+        }
+    }
+
+    rehash();
+}
+
 unsigned int Puzzle::inversionCount() const
 {
     unsigned int count{0};
@@ -253,6 +424,11 @@ unsigned int Puzzle::inversionCount() const
     return count;
 }
 
+std::uint64_t Puzzle::getHash() const
+{
+    return hash;
+}
+
 bool Puzzle::isSolvable() const
 {
     int invCount = inversionCount();
@@ -282,39 +458,52 @@ bool Puzzle::isSolved() const
     return (inversionCount() == 0);
 }
 
-std::vector<Puzzle> Puzzle::solve(const Heuristic &heuristic, std::atomic<bool> &running) const
+std::vector<Puzzle::Move> Puzzle::solveMoves(const Heuristic &heuristic, std::atomic<bool> &running, const Options &options, Stats &stats) const
 {
     if (!isSolvable())
         throw UnsolvableException();
 
-    std::deque<Puzzle> path;
-    path.push_back(*this); // Add first state
-
-    unsigned int threshold = heuristic(*this);
-
-    while (true)
+    std::vector<Move> moves{};
+    if (options.engine == Engine::FRINGE && dimension <= PACK_MAX_DIMENSION)
     {
-        if (!running)
-            throw CancelledException();
-
-        unsigned int result = search(path, 0, threshold, heuristic, running);
-
-        if (result == 0)
-            break;
-
-        if (result == std::numeric_limits<unsigned int>::max())
-            throw MaxThresholdException();
-
-        threshold = result;
+        stats.engine = Engine::FRINGE;
+        Search::FringeSearch search{*this, heuristic, options};
+        moves = search.run(running, stats);
+    }
+    else if (options.engine == Engine::A_STAR && dimension <= PACK_MAX_DIMENSION)
+    {
+        // Changed back to IDA_STAR if it runs out of memory
+        stats.engine = Engine::A_STAR;
+        Search::AStarSearch search{*this, heuristic, options};
+        moves = search.run(running, stats);
+    }
+    else if (options.engine == Engine::PARALLEL_WINDOW && options.weight == 1)
+    {
+        stats.engine = Engine::PARALLEL_WINDOW;
+        Search::ParallelWindowSearch search{*this, heuristic, options};
+        moves = search.run(running, stats);
+    }
+    else
+    {
+        // Fringe search and A* keep packed states, weighted searches have no window to run
+        stats.engine = Engine::IDA_STAR;
+        Search::IDAStarSearch search{*this, heuristic, options};
+        moves = search.run(running, stats);
     }
-
-    // Move states from deque to vector for ease of use
-    std::vector<Puzzle> pathVec;
-    pathVec.reserve(path.size());
-    std::move(std::begin(path), std::end(path), std::back_inserter(pathVec));
 
     running = false;
-    return pathVec;
+    return moves;
+}
+
+std::vector<Puzzle> Puzzle::solve(const Heuristic &heuristic, std::atomic<bool> &running, const Options &options, Stats &stats) const
+{
+    return trace(solveMoves(heuristic, running, options, stats));
+}
+
+std::vector<Puzzle> Puzzle::solve(const Heuristic &heuristic, std::atomic<bool> &running) const
+{
+    Stats stats{};
+    return solve(heuristic, running, Options{}, stats);
 }
 
 std::vector<Puzzle> Puzzle::solve(const Heuristic &heuristic) const
@@ -323,42 +512,30 @@ std::vector<Puzzle> Puzzle::solve(const Heuristic &heuristic) const
     return solve(heuristic, running);
 }
 
-unsigned int Puzzle::search(std::deque<Puzzle> &path, unsigned int moveCost, unsigned int threshold, const Heuristic &heuristic, std::atomic<bool> &running)
+Puzzle::AnytimeResult Puzzle::solveAnytime(const Heuristic &heuristic, std::atomic<bool> &running, const Options &options, Stats &stats) const
 {
-    const Puzzle &state = *path.rbegin(); // Get last state
+    if (!isSolvable())
+        throw UnsolvableException();
 
-    unsigned int h = heuristic(state);
-    // A heuristic value of 0 means we have reached the goal
-    if (h == 0)
-        return 0; // Found
+    Search::AnytimeSearch search{*this, heuristic, options};
+    AnytimeResult result{search.run(running, stats)};
 
-    if (!running)
-        throw CancelledException();
+    running = false;
+    return result;
+}
 
-    unsigned int cost = moveCost + h;
-    if (cost > threshold)
-        return cost;
+std::vector<Puzzle> Puzzle::trace(const std::vector<Move> &moves) const
+{
+    std::vector<Puzzle> states;
+    states.reserve(moves.size() + 1);
 
-    unsigned int min = std::numeric_limits<unsigned int>::max();
-    for (Move &nextMove : state.validMoves())
+    states.push_back(*this); // Add first state
+    for (Move move : moves)
     {
-        Puzzle nextState{state};
-        nextState.move(nextMove);
-
-        if (std::find(path.begin(), path.end(), nextState) == path.end())
-        {
-            path.push_back(std::move(nextState));
-
-            unsigned int temp = search(path, moveCost + 1, threshold, heuristic, running);
-            if (temp == 0)
-                return 0; // Found
-            if (temp < min)
-                min = temp;
-
-            // Pop state from path if not leading to goal
-            path.pop_back();
-        }
+        Puzzle next{states.back()};
+        next.move(move);
+        states.push_back(std::move(next));
     }
 
-    return min;
-}
\ No newline at end of file
+    return states;
+}
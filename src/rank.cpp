@@ -0,0 +1,57 @@
+#include "rank.h"
+
+#include <bitset>
+
+std::uint64_t Rank::size(int count, int n)
+{
+    std::uint64_t size{1};
+    for (int i{0}; i < count; i++)
+        size *= n - i;
+
+    return size;
+}
+
+std::uint64_t Rank::rank(const int *items, int count, int n)
+{
+    std::uint64_t rank{0};
+    std::uint64_t used{0};
+
+    for (int i{0}; i < count; i++)
+    {
+        // Digit is the number of values still unused that are smaller than this one
+        std::uint64_t below{(std::uint64_t{1} << items[i]) - 1};
+        int digit{items[i] - static_cast<int>(std::bitset<64>(used & below).count())};
+
+        rank = (rank * (n - i)) + digit;
+        used |= std::uint64_t{1} << items[i];
+    }
+
+    return rank;
+}
+
+void Rank::unrank(std::uint64_t rank, int *items, int count, int n)
+{
+    // Digits come out least significant first, i.e. for the last item
+    for (int i{count - 1}; i >= 0; i--)
+    {
+        items[i] = rank % (n - i);
+        rank /= n - i;
+    }
+
+    // Turn each digit into the digit-th value not used by an earlier item
+    std::uint64_t used{0};
+    for (int i{0}; i < count; i++)
+    {
+        int value{0};
+        for (int skip{items[i]};; value++)
+        {
+            if (used & (std::uint64_t{1} << value))
+                continue;
+            if (skip-- == 0)
+                break;
+        }
+
+        items[i] = value;
+        used |= std::uint64_t{1} << value;
+    }
+}
@@ -0,0 +1,1045 @@
+#include "search.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <thread>
+
+const std::array<unsigned int, 3> Search::AnytimeSearch::WEIGHTS{5, 3, 2};
+
+unsigned int Search::IDAStarSearch::defaultMaxDepth(int dimension)
+{
+    // Generous bound, well above the longest optimal solution of any board we can solve
+    return 5 * dimension * dimension * dimension;
+}
+
+Search::IDAStarSearch::IDAStarSearch(const Puzzle &start, const Puzzle::Heuristic &heuristic, const Puzzle::Options &options)
+    : own(heuristic.forSearch()), heuristic(own ? *own : heuristic), options(options), automaton(MoveAutomaton::get(options.pruneLength)),
+      start(start), board(start), bound(std::numeric_limits<unsigned int>::max())
+{
+    unsigned int maxDepth{options.maxDepth > 0 ? options.maxDepth : defaultMaxDepth(start.getDimension())};
+
+    frames.resize(maxDepth + 1);
+    best.reserve(maxDepth);
+}
+
+unsigned int Search::IDAStarSearch::getMaxDepth() const
+{
+    return frames.size() - 1;
+}
+
+void Search::IDAStarSearch::setBound(unsigned int bound)
+{
+    this->bound = bound;
+}
+
+std::vector<Puzzle::Move> Search::IDAStarSearch::run(std::atomic<bool> &running, Puzzle::Stats &stats)
+{
+    if (!resume(running, stats))
+        throw Puzzle::CancelledException();
+
+    return best;
+}
+
+bool Search::IDAStarSearch::step(std::atomic<bool> &running, Puzzle::Stats &stats, unsigned long long budget, std::chrono::steady_clock::time_point until)
+{
+    this->budget = budget;
+    pause = until;
+    bool finished{resume(running, stats)};
+    this->budget = std::numeric_limits<unsigned long long>::max();
+    pause = std::chrono::steady_clock::time_point::max();
+
+    return finished;
+}
+
+bool Search::IDAStarSearch::resume(std::atomic<bool> &running, Puzzle::Stats &stats)
+{
+    unsigned int maxDepth = frames.size() - 1;
+    unsigned int result{};
+
+    switch (phase)
+    {
+    case Phase::STARTING:
+        threshold = options.weight * heuristic(start);
+        lowerBound = threshold;
+        phase = Phase::ITERATING;
+        [[fallthrough]];
+
+    case Phase::ITERATING:
+        while (true)
+        {
+            // Weighted thresholds overestimate depth, deeper paths are cut off while searching instead
+            if (!active && options.weight == 1 && threshold > maxDepth)
+                throw Puzzle::MaxThresholdException();
+
+            if (!search(running, result))
+                return false;
+
+            stats.iterations++;
+            stats.nodes += nodes;
+
+            if (result == 0)
+                break;
+
+            if (result == std::numeric_limits<unsigned int>::max())
+                throw Puzzle::MaxThresholdException();
+
+            lowerBound = result;
+            if (options.threshold == Puzzle::Threshold::CONTROLLED)
+                threshold = std::max(std::min(controlledThreshold(result, stats.iterationsSaved), maxDepth), result);
+            else
+                threshold = result;
+        }
+
+        // A controlled threshold may have skipped past the optimal cost.
+        // Unless the solution meets the lower bound, run a final branch and bound pass
+        // below its cost to either find a shorter one or prove it optimal.
+        // Weighted solutions make no promise of optimality to begin with.
+        if (options.weight != 1 || best.size() <= lowerBound)
+        {
+            phase = Phase::FINISHED;
+            return true;
+        }
+
+        phase = Phase::BOUNDING;
+        bounded = true;
+        threshold = best.size() - 1;
+        [[fallthrough]];
+
+    case Phase::BOUNDING:
+        if (!search(running, result))
+            return false;
+
+        stats.iterations++;
+        stats.nodes += nodes;
+
+        bounded = false;
+        phase = Phase::FINISHED;
+        [[fallthrough]];
+
+    case Phase::FINISHED:
+    default:
+        return true;
+    }
+}
+
+unsigned int Search::IDAStarSearch::iterate(unsigned int threshold, std::atomic<bool> &running, Puzzle::Stats &stats)
+{
+    this->threshold = threshold;
+
+    unsigned int result{};
+    if (!search(running, result))
+        throw Puzzle::CancelledException();
+
+    stats.iterations++;
+    stats.nodes += nodes;
+
+    return result;
+}
+
+const std::vector<Puzzle::Move> &Search::IDAStarSearch::solution() const
+{
+    return best;
+}
+
+unsigned int Search::IDAStarSearch::getThreshold() const
+{
+    return threshold;
+}
+
+unsigned long long Search::IDAStarSearch::getNodes() const
+{
+    return active ? nodes : 0;
+}
+
+bool Search::IDAStarSearch::search(std::atomic<bool> &running, unsigned int &result)
+{
+    unsigned int maxDepth = frames.size() - 1;
+
+    if (!active)
+    {
+        if (!running.load(std::memory_order_relaxed))
+            return false;
+
+        nodes = 0;
+        histogram.fill(0);
+        min = std::numeric_limits<unsigned int>::max();
+
+        board = start;
+
+        unsigned int h = heuristic(board);
+        // A heuristic value of 0 means we have reached the goal
+        if (h == 0)
+        {
+            record(0);
+            result = 0;
+            return true;
+        }
+        if (h >= bound)
+        {
+            result = min;
+            return true;
+        }
+        if (options.weight * h > threshold)
+        {
+            result = options.weight * h;
+            return true;
+        }
+
+        depth = 0;
+        frames[0] = Frame{NO_MOVE, 0, 0, h, MoveAutomaton::START};
+        nodes++;
+
+        active = true;
+    }
+
+    while (true)
+    {
+        Frame &frame = frames[depth];
+
+        // All children tried, backtrack to the parent
+        if (frame.nextMove == NO_MOVE)
+        {
+            if (depth == 0)
+                break;
+
+            board.move(Puzzle::inverse(static_cast<Puzzle::Move>(frame.move)));
+            depth--;
+            continue;
+        }
+
+        Puzzle::Move move{options.order[frame.nextMove++]};
+
+        // Skip paths that reach the same position as a shorter or equal one, e.g. undoing the last move
+        unsigned int state{automaton->next(frame.state, move)};
+        if (state == MoveAutomaton::DEAD)
+            continue;
+        if (!board.move(move))
+            continue;
+
+        unsigned int g = frame.g + 1;
+
+        // Does not fit on the stack; weighted thresholds can pass the maximum depth
+        if (g > maxDepth)
+        {
+            board.move(Puzzle::inverse(move));
+            continue;
+        }
+
+        unsigned int h = heuristic.update(board, frame.h, move);
+
+        if (h == 0 && g <= threshold && g < bound)
+        {
+            frames[depth + 1].move = move;
+            record(depth + 1);
+
+            if (!bounded)
+            {
+                active = false;
+                result = 0; // Found
+                return true;
+            }
+
+            // Only look for even shorter solutions from now on
+            threshold = g - 1;
+            board.move(Puzzle::inverse(move));
+            continue;
+        }
+
+        // Cannot lead to a solution shorter than the bound
+        if (g + h >= bound)
+        {
+            board.move(Puzzle::inverse(move));
+            continue;
+        }
+
+        unsigned int cost = g + (options.weight * h);
+        if (cost > threshold)
+        {
+            histogram[std::min(cost - threshold - 1, HISTOGRAM_SIZE - 1)]++;
+            if (cost < min)
+                min = cost;
+
+            board.move(Puzzle::inverse(move));
+            continue;
+        }
+
+        depth++;
+        frames[depth] = Frame{static_cast<unsigned char>(move), 0, g, h, state};
+        nodes++;
+
+        // Stack and board agree here, so this is where the search can stop and later go on
+        if (nodes % CHECK_INTERVAL == 0)
+        {
+            if (!running.load(std::memory_order_relaxed))
+                return false;
+
+            if (budget <= CHECK_INTERVAL)
+                return false;
+            budget -= CHECK_INTERVAL;
+
+            auto now{std::chrono::steady_clock::now()};
+            if (now >= options.deadline)
+                throw Puzzle::DeadlineException();
+            if (now >= pause)
+                return false;
+        }
+    }
+
+    active = false;
+    result = min;
+    return true;
+}
+
+void Search::IDAStarSearch::save(std::ostream &out) const
+{
+    out << phase << ' ' << threshold << ' ' << lowerBound << ' ' << bound << ' ' << bounded << '\n';
+
+    out << best.size();
+    for (Puzzle::Move move : best)
+        out << ' ' << move;
+    out << '\n';
+
+    out << active << ' ' << depth << ' ' << min << ' ' << nodes << '\n';
+    for (unsigned long long count : histogram)
+        out << count << ' ';
+    out << '\n';
+
+    // The board is rebuilt from the moves on the stack
+    for (unsigned int n{0}; active && n <= depth; n++)
+    {
+        const Frame &frame{frames[n]};
+        out << static_cast<unsigned int>(frame.move) << ' ' << static_cast<unsigned int>(frame.nextMove) << ' ' << frame.g << ' ' << frame.h << '\n';
+    }
+}
+
+void Search::IDAStarSearch::load(std::istream &in)
+{
+    unsigned int value{};
+
+    in >> value >> threshold >> lowerBound >> bound >> bounded;
+    phase = static_cast<Phase>(value);
+
+    std::size_t length{};
+    in >> length;
+    best.clear();
+    for (std::size_t n{0}; n < length && in >> value; n++)
+        best.push_back(static_cast<Puzzle::Move>(value));
+
+    in >> active >> depth >> min >> nodes;
+    for (unsigned long long &count : histogram)
+        in >> count;
+
+    if (!in || phase > Phase::FINISHED || best.size() != length || (active && depth >= frames.size()))
+        throw CheckpointException();
+
+    board = start;
+    for (unsigned int n{0}; active && n <= depth; n++)
+    {
+        unsigned int move{}, nextMove{};
+        Frame &frame{frames[n]};
+        in >> move >> nextMove >> frame.g >> frame.h;
+
+        frame.move = move;
+        frame.nextMove = nextMove;
+        frame.state = MoveAutomaton::START;
+
+        if (!in || nextMove > NO_MOVE || (n > 0 && (move >= NO_MOVE || !board.move(static_cast<Puzzle::Move>(move)))))
+            throw CheckpointException();
+
+        // The automaton state follows from the moves
+        if (n > 0)
+        {
+            frame.state = automaton->next(frames[n - 1].state, static_cast<Puzzle::Move>(move));
+            if (frame.state == MoveAutomaton::DEAD)
+                throw CheckpointException();
+        }
+    }
+}
+
+void Search::IDAStarSearch::record(unsigned int depth)
+{
+    best.clear();
+    for (unsigned int n{1}; n <= depth; n++)
+        best.push_back(static_cast<Puzzle::Move>(frames[n].move));
+}
+
+unsigned int Search::IDAStarSearch::controlledThreshold(unsigned int minimum, unsigned int &saved) const
+{
+    // Pick the smallest threshold whose newly admitted frontier is at least as large as
+    // the tree expanded so far, so that the next iteration roughly doubles the node count
+    unsigned long long admitted{0};
+    unsigned int chosen{minimum};
+    unsigned int values{0};
+
+    for (unsigned int n{0}; n < HISTOGRAM_SIZE; n++)
+    {
+        if (histogram[n] == 0)
+            continue;
+
+        admitted += histogram[n];
+        chosen = threshold + n + 1;
+        values++;
+
+        if (admitted >= nodes)
+            break;
+    }
+
+    // Every distinct f-value passed on the way is an iteration plain IDA* would have run
+    if (values > 1)
+        saved += values - 1;
+
+    return std::max(chosen, minimum);
+}
+
+const std::chrono::milliseconds Search::ParallelWindowSearch::POLL_INTERVAL{10};
+
+Search::ParallelWindowSearch::ParallelWindowSearch(const Puzzle &start, const Puzzle::Heuristic &heuristic, const Puzzle::Options &options)
+    : heuristic(heuristic), options(options), start(start),
+      workers(options.threads > 0 ? options.threads : std::max(std::thread::hardware_concurrency(), 1u))
+{
+    // Every move takes the blank one cell closer to or further from the bottom right corner
+    int dimension{start.getDimension()};
+    int blank{start.getBlank()};
+    parity = (2 * (dimension - 1) - (blank / dimension) - (blank % dimension)) % 2;
+}
+
+unsigned int Search::ParallelWindowSearch::parityCeil(unsigned int threshold) const
+{
+    return threshold + ((threshold ^ parity) & 1);
+}
+
+void Search::ParallelWindowSearch::cancelStale()
+{
+    for (Worker &worker : workers)
+    {
+        if (worker.searching && (worker.threshold < lowerBound || (found && worker.threshold >= best.size())))
+            worker.running = false;
+    }
+}
+
+std::vector<Puzzle::Move> Search::ParallelWindowSearch::run(std::atomic<bool> &running, Puzzle::Stats &stats)
+{
+    next = parityCeil(heuristic(start));
+    remaining = workers.size();
+
+    std::vector<std::thread> threads{};
+    for (Worker &worker : workers)
+        threads.emplace_back(&ParallelWindowSearch::work, this, std::ref(worker), std::ref(stats));
+
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        while (!done.wait_for(lock, POLL_INTERVAL, [this]() { return remaining == 0; }))
+        {
+            if (stopped || running.load())
+                continue;
+
+            stopped = true;
+            for (Worker &worker : workers)
+                worker.running = false;
+        }
+    }
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+    if (stopped)
+        throw Puzzle::CancelledException();
+    if (!found)
+        throw Puzzle::MaxThresholdException();
+
+    return best;
+}
+
+void Search::ParallelWindowSearch::work(Worker &worker, Puzzle::Stats &stats)
+{
+    unsigned int maxDepth{options.maxDepth > 0 ? options.maxDepth : IDAStarSearch::defaultMaxDepth(start.getDimension())};
+
+    std::unique_lock<std::mutex> lock{mutex};
+    // Thresholds from the best solution's length up can only find solutions as long or longer
+    while (!stopped && next <= maxDepth && (!found || next < best.size()))
+    {
+        worker.threshold = next;
+        worker.searching = true;
+        worker.running = true;
+        next += 2;
+        lock.unlock();
+
+        IDAStarSearch search{start, heuristic, options};
+        Puzzle::Stats iteration{};
+        bool finished{false};
+        unsigned int result{};
+        std::exception_ptr failure{};
+
+        try
+        {
+            result = search.iterate(worker.threshold, worker.running, iteration);
+            finished = true;
+        }
+        catch (Puzzle::CancelledException &)
+        {
+            // The nodes searched until then were still searched
+            iteration.nodes += search.getNodes();
+        }
+        catch (...)
+        {
+            failure = std::current_exception();
+        }
+
+        lock.lock();
+        worker.searching = false;
+        stats.nodes += iteration.nodes;
+        stats.iterations += iteration.iterations;
+
+        if (failure)
+        {
+            if (!error)
+                error = failure;
+            stopped = true;
+            for (Worker &other : workers)
+                other.running = false;
+        }
+        else if (finished && result == 0)
+        {
+            if (!found || search.solution().size() < best.size())
+                best = search.solution();
+            found = true;
+        }
+        else if (finished)
+        {
+            // No f-value exceeding the threshold means no solution fits in the maximum depth
+            lowerBound = std::max(lowerBound, result);
+            next = result == std::numeric_limits<unsigned int>::max() ? result : std::max(next, parityCeil(result));
+        }
+
+        cancelStale();
+    }
+
+    remaining--;
+    done.notify_all();
+}
+
+const unsigned int Search::FringeSearch::NONE{std::numeric_limits<unsigned int>::max()};
+
+Search::FringeSearch::FringeSearch(const Puzzle &start, const Puzzle::Heuristic &heuristic, const Puzzle::Options &options)
+    : own(heuristic.forSearch()), heuristic(own ? *own : heuristic), options(options), start(start)
+{
+}
+
+unsigned int &Search::FringeSearch::slot(std::uint64_t state)
+{
+    std::size_t mask{table.size() - 1};
+    std::size_t n = (state * 0x9E3779B97F4A7C15ull) >> 20;
+
+    while (true)
+    {
+        unsigned int &entry{table[n & mask]};
+        if (entry == NONE || nodes[entry].state == state)
+            return entry;
+
+        n++;
+    }
+}
+
+std::size_t Search::FringeSearch::footprint() const
+{
+    return nodes.capacity() * sizeof(Node) + table.size() * sizeof(unsigned int);
+}
+
+unsigned int Search::FringeSearch::find(std::uint64_t state)
+{
+    return slot(state);
+}
+
+unsigned int Search::FringeSearch::insert(std::uint64_t state)
+{
+    if ((nodes.size() + 1) * 2 > table.size())
+    {
+        table.assign(std::max<std::size_t>(table.size() * 2, 1 << 16), NONE);
+        for (unsigned int n{1}; n < nodes.size(); n++)
+            slot(nodes[n].state) = n;
+    }
+
+    unsigned int node = nodes.size();
+    nodes.push_back(Node{state, 0, 0, NONE, NONE, NONE, Puzzle::Move::UP, false});
+    slot(state) = node;
+
+    return node;
+}
+
+void Search::FringeSearch::link(unsigned int node, unsigned int after)
+{
+    nodes[node].prev = after;
+    nodes[node].next = nodes[after].next;
+    nodes[nodes[after].next].prev = node;
+    nodes[after].next = node;
+    nodes[node].listed = true;
+}
+
+void Search::FringeSearch::unlink(unsigned int node)
+{
+    nodes[nodes[node].prev].next = nodes[node].next;
+    nodes[nodes[node].next].prev = nodes[node].prev;
+    nodes[node].listed = false;
+}
+
+std::vector<Puzzle::Move> Search::FringeSearch::run(std::atomic<bool> &running, Puzzle::Stats &stats)
+{
+    const unsigned int HEAD{0};
+    unsigned int maxDepth{options.maxDepth > 0 ? options.maxDepth : IDAStarSearch::defaultMaxDepth(start.getDimension())};
+
+    Puzzle board{start};
+
+    nodes.clear();
+    table.clear();
+    nodes.push_back(Node{0, 0, 0, NONE, HEAD, HEAD, Puzzle::Move::UP, false});
+
+    unsigned int root{insert(start.pack())};
+    nodes[root].h = heuristic(start);
+    link(root, HEAD);
+
+    unsigned int limit{options.weight * nodes[root].h};
+    unsigned long long expanded{0};
+
+    while (nodes[HEAD].next != HEAD)
+    {
+        if (!running.load(std::memory_order_relaxed))
+            throw Puzzle::CancelledException();
+
+        unsigned int min{std::numeric_limits<unsigned int>::max()};
+        stats.iterations++;
+
+        unsigned int node{nodes[HEAD].next};
+        while (node != HEAD)
+        {
+            Node current{nodes[node]};
+
+            // Left for a later iteration
+            unsigned int cost{current.g + (options.weight * current.h)};
+            if (cost > limit)
+            {
+                min = std::min(min, cost);
+                node = current.next;
+                continue;
+            }
+
+            // A heuristic value of 0 means we have reached the goal
+            if (current.h == 0)
+            {
+                stats.nodes += expanded;
+                stats.peakMemory = std::max(stats.peakMemory, footprint());
+
+                std::vector<Puzzle::Move> moves{};
+                for (; nodes[node].parent != NONE; node = nodes[node].parent)
+                    moves.push_back(nodes[node].move);
+                std::reverse(moves.begin(), moves.end());
+
+                return moves;
+            }
+
+            board.unpack(current.state);
+            int blank{board.getBlank()};
+
+            // Children go right after their parent in move order, so they are visited next
+            unsigned int after{node};
+            for (Puzzle::Move move : options.order)
+            {
+                if (current.parent != NONE && move == Puzzle::inverse(current.move))
+                    continue;
+                if (current.g + 1 > maxDepth || !board.move(move))
+                    continue;
+
+                // The tile that slid into the blank's cell
+                std::uint64_t tile(board.get(blank));
+                std::uint64_t state{current.state + (tile << (4 * blank)) - (tile << (4 * board.getBlank()))};
+
+                unsigned int child{find(state)};
+                if (child == NONE)
+                {
+                    child = insert(state);
+                    nodes[child].h = heuristic.update(board, current.h, move);
+                }
+                // Reached before on a path no longer than this one
+                else if (nodes[child].g <= current.g + 1)
+                {
+                    board.move(Puzzle::inverse(move));
+                    continue;
+                }
+                else if (nodes[child].listed)
+                {
+                    unlink(child);
+                }
+
+                nodes[child].g = current.g + 1;
+                nodes[child].move = move;
+                nodes[child].parent = node;
+
+                link(child, after);
+                after = child;
+
+                board.move(Puzzle::inverse(move));
+            }
+
+            expanded++;
+            if (expanded % CHECK_INTERVAL == 0)
+            {
+                if (!running.load(std::memory_order_relaxed))
+                    throw Puzzle::CancelledException();
+
+                if (std::chrono::steady_clock::now() >= options.deadline)
+                    throw Puzzle::DeadlineException();
+            }
+
+            unsigned int next{nodes[node].next};
+            unlink(node);
+            node = next;
+        }
+
+        limit = min;
+    }
+
+    // Every path within the maximum depth has been tried
+    stats.nodes += expanded;
+    stats.peakMemory = std::max(stats.peakMemory, footprint());
+    throw Puzzle::MaxThresholdException();
+}
+
+const unsigned int Search::AStarSearch::NONE{std::numeric_limits<unsigned int>::max()};
+
+Search::AStarSearch::AStarSearch(const Puzzle &start, const Puzzle::Heuristic &heuristic, const Puzzle::Options &options)
+    : own(heuristic.forSearch()), heuristic(own ? *own : heuristic), options(options), start(start)
+{
+}
+
+Search::AStarSearch::Node &Search::AStarSearch::node(unsigned int index)
+{
+    return blocks[index / BLOCK_SIZE][index % BLOCK_SIZE];
+}
+
+unsigned int &Search::AStarSearch::slot(std::uint64_t state)
+{
+    std::size_t mask{table.size() - 1};
+    std::size_t n = (state * 0x9E3779B97F4A7C15ull) >> 20;
+
+    while (true)
+    {
+        unsigned int &entry{table[n & mask]};
+        if (entry == NONE || node(entry).state == state)
+            return entry;
+
+        n++;
+    }
+}
+
+std::size_t Search::AStarSearch::footprint() const
+{
+    std::size_t bytes{blocks.size() * BLOCK_SIZE * sizeof(Node) + table.size() * sizeof(unsigned int)};
+    for (const std::vector<unsigned int> &byG : buckets)
+        bytes += byG.capacity() * sizeof(unsigned int);
+
+    return bytes;
+}
+
+bool Search::AStarSearch::reserve(Puzzle::Stats &stats)
+{
+    // Room for every child of the next expansion
+    if ((count + 4) * 2 <= table.size())
+        return true;
+
+    std::size_t size{std::max<std::size_t>(table.size() * 2, 1 << 16)};
+    // The old table is still held while the new one is filled
+    if (footprint() + size * sizeof(unsigned int) > options.memoryLimit)
+        return false;
+
+    stats.peakMemory = std::max(stats.peakMemory, footprint() + size * sizeof(unsigned int));
+
+    table.assign(size, NONE);
+    // Later nodes of a state replaced the earlier ones, so they take the slot last
+    for (unsigned int n{0}; n < count; n++)
+        slot(node(n).state) = n;
+
+    return true;
+}
+
+bool Search::AStarSearch::allocate(unsigned int &index, Puzzle::Stats &stats)
+{
+    if (count == blocks.size() * BLOCK_SIZE)
+    {
+        if (footprint() + BLOCK_SIZE * sizeof(Node) > options.memoryLimit)
+            return false;
+
+        // Left uninitialized, every node is written whole when allocated
+        blocks.emplace_back(new Node[BLOCK_SIZE]);
+        stats.peakMemory = std::max(stats.peakMemory, footprint());
+    }
+
+    index = count++;
+    return true;
+}
+
+void Search::AStarSearch::push(unsigned int index)
+{
+    Node &current{node(index)};
+    unsigned int f{current.g + (options.weight * current.h)};
+
+    if (f >= buckets.size())
+        buckets.resize(f + 1);
+
+    std::vector<unsigned int> &byG{buckets[f]};
+    if (current.g >= byG.size())
+        byG.resize(current.g + 1, NONE);
+
+    current.next = byG[current.g];
+    byG[current.g] = index;
+
+    // Only an inconsistent heuristic lowers f along a path
+    minF = std::min(minF, f);
+}
+
+unsigned int Search::AStarSearch::pop()
+{
+    for (; minF < buckets.size(); minF++)
+    {
+        // Lists past the last one holding nodes are dropped, so the deepest is always at the back
+        std::vector<unsigned int> &byG{buckets[minF]};
+        while (!byG.empty())
+        {
+            unsigned int index{byG.back()};
+            if (index == NONE)
+            {
+                byG.pop_back();
+                continue;
+            }
+
+            byG.back() = node(index).next;
+            return index;
+        }
+    }
+
+    return NONE;
+}
+
+std::vector<Puzzle::Move> Search::AStarSearch::run(std::atomic<bool> &running, Puzzle::Stats &stats)
+{
+    std::vector<Puzzle::Move> moves{};
+    if (search(running, stats, moves))
+        return moves;
+
+    // Out of memory, release it all for IDA*, which needs next to none
+    blocks.clear();
+    table.clear();
+    table.shrink_to_fit();
+    buckets.clear();
+    buckets.shrink_to_fit();
+    count = 0;
+
+    stats.engine = Puzzle::Engine::IDA_STAR;
+    IDAStarSearch fallback{start, heuristic, options};
+    return fallback.run(running, stats);
+}
+
+bool Search::AStarSearch::search(std::atomic<bool> &running, Puzzle::Stats &stats, std::vector<Puzzle::Move> &moves)
+{
+    // Depths must fit in a node
+    unsigned int maxDepth{std::min<unsigned int>(options.maxDepth > 0 ? options.maxDepth : IDAStarSearch::defaultMaxDepth(start.getDimension()),
+                                                 std::numeric_limits<unsigned short>::max())};
+
+    Puzzle board{start};
+
+    unsigned int root{};
+    if (!reserve(stats) || !allocate(root, stats))
+        return false;
+
+    std::uint64_t packed{start.pack()};
+    node(root) = Node{packed, NONE, NONE, 0, static_cast<unsigned short>(heuristic(start)), 0, false, false};
+    slot(packed) = root;
+    minF = options.weight * node(root).h;
+    push(root);
+
+    stats.iterations++;
+    unsigned long long expanded{0};
+
+    for (unsigned int index{pop()}; index != NONE; index = pop())
+    {
+        // Blocks never move, so this stays valid while children are allocated
+        Node &current{node(index)};
+        if (current.stale || current.closed)
+            continue;
+
+        // A heuristic value of 0 means we have reached the goal
+        if (current.h == 0)
+        {
+            stats.nodes += expanded;
+
+            for (; node(index).parent != NONE; index = node(index).parent)
+                moves.push_back(static_cast<Puzzle::Move>(node(index).move));
+            std::reverse(moves.begin(), moves.end());
+
+            return true;
+        }
+
+        if (!reserve(stats))
+        {
+            stats.nodes += expanded;
+            return false;
+        }
+
+        current.closed = true;
+        board.unpack(current.state);
+        int blank{board.getBlank()};
+
+        for (Puzzle::Move move : options.order)
+        {
+            if (current.parent != NONE && move == Puzzle::inverse(static_cast<Puzzle::Move>(current.move)))
+                continue;
+            if (current.g + 1u > maxDepth || !board.move(move))
+                continue;
+
+            // The tile that slid into the blank's cell
+            std::uint64_t tile(board.get(blank));
+            std::uint64_t state{current.state + (tile << (4 * blank)) - (tile << (4 * board.getBlank()))};
+            unsigned int g{current.g + 1u};
+
+            unsigned int &entry{slot(state)};
+            // Reached before on a path no longer than this one
+            if (entry != NONE && node(entry).g <= g)
+            {
+                board.move(Puzzle::inverse(move));
+                continue;
+            }
+
+            unsigned int child{};
+            if (!allocate(child, stats))
+            {
+                stats.nodes += expanded;
+                return false;
+            }
+
+            unsigned int h{entry != NONE ? node(entry).h : heuristic.update(board, current.h, move)};
+            if (entry != NONE)
+                node(entry).stale = true;
+
+            node(child) = Node{state, index, NONE, static_cast<unsigned short>(g), static_cast<unsigned short>(h), static_cast<unsigned char>(move), false, false};
+            entry = child;
+            push(child);
+
+            board.move(Puzzle::inverse(move));
+        }
+
+        expanded++;
+        if (expanded % CHECK_INTERVAL == 0)
+        {
+            if (!running.load(std::memory_order_relaxed))
+                throw Puzzle::CancelledException();
+
+            if (std::chrono::steady_clock::now() >= options.deadline)
+                throw Puzzle::DeadlineException();
+        }
+    }
+
+    // Every state within the maximum depth has been expanded
+    stats.nodes += expanded;
+    throw Puzzle::MaxThresholdException();
+}
+
+Search::AnytimeSearch::AnytimeSearch(const Puzzle &start, const Puzzle::Heuristic &heuristic, const Puzzle::Options &options)
+    : heuristic(heuristic), options(options), start(start)
+{
+}
+
+Puzzle::AnytimeResult Search::AnytimeSearch::run(std::atomic<bool> &running, Puzzle::Stats &stats)
+{
+    Puzzle::AnytimeResult result{};
+    result.lowerBound = heuristic(start);
+
+    Puzzle::Options admissible{options};
+    admissible.weight = 1;
+    IDAStarSearch exact{start, heuristic, admissible};
+
+    unsigned int threshold{result.lowerBound};
+
+    try
+    {
+        for (unsigned int n{0}; !result.optimal(); n++)
+        {
+            // Look for a better solution with the next smaller weight
+            if (n < WEIGHTS.size())
+            {
+                improve(result, WEIGHTS[n], running, stats);
+                if (result.optimal())
+                    break;
+            }
+
+            // Deeper iterations would not fit on the stack, the bound can not be raised further
+            if (threshold > exact.getMaxDepth())
+            {
+                if (n + 1 >= WEIGHTS.size())
+                    break;
+                continue;
+            }
+
+            // Then raise the lower bound by an admissible iteration
+            if (result.found)
+                exact.setBound(result.moves.size());
+
+            unsigned int next = exact.iterate(threshold, running, stats);
+            if (next == 0)
+            {
+                result.found = true;
+                result.moves = exact.solution();
+                result.lowerBound = result.moves.size();
+                break;
+            }
+
+            // Nothing left below the bound, so the solution we have is optimal
+            if (next == std::numeric_limits<unsigned int>::max())
+            {
+                if (result.found)
+                    result.lowerBound = result.moves.size();
+                break;
+            }
+
+            threshold = next;
+            result.lowerBound = next;
+
+            // All solutions of a puzzle have the same parity
+            if (result.found && result.lowerBound < result.moves.size())
+                result.lowerBound += (result.moves.size() - result.lowerBound) % 2;
+        }
+    }
+    catch (Puzzle::DeadlineException &)
+    {
+        // Out of time, return what we have
+    }
+    catch (Puzzle::CancelledException &)
+    {
+    }
+
+    return result;
+}
+
+void Search::AnytimeSearch::improve(Puzzle::AnytimeResult &result, unsigned int weight, std::atomic<bool> &running, Puzzle::Stats &stats)
+{
+    Puzzle::Options weighted{options};
+    weighted.weight = weight;
+
+    IDAStarSearch search{start, heuristic, weighted};
+    if (result.found)
+        search.setBound(result.moves.size());
+
+    try
+    {
+        result.moves = search.run(running, stats);
+        result.found = true;
+    }
+    catch (Puzzle::MaxThresholdException &)
+    {
+        // No shorter solution within reach of this weight
+    }
+
+    if (result.found && result.lowerBound < result.moves.size())
+        result.lowerBound += (result.moves.size() - result.lowerBound) % 2;
+}
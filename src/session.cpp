@@ -0,0 +1,208 @@
+#include "session.h"
+
+#include <fstream>
+
+const char SolverSession::CHECKPOINT_HEADER[]{"fifteen-checkpoint 3"};
+
+SolverSession::SolverSession(const Puzzle &puzzle, std::shared_ptr<const Puzzle::Heuristic> heuristic, const Puzzle::Options &options)
+    : puzzle(puzzle), heuristic(heuristic), options(options), search(this->puzzle, *this->heuristic, options)
+{
+}
+
+SolverSession::~SolverSession()
+{
+    cancel();
+}
+
+void SolverSession::setCallback(Callback callback)
+{
+    this->callback = callback;
+}
+
+bool SolverSession::start()
+{
+    // Collect the worker of the previous run
+    wait();
+
+    State current{state};
+    if (current != State::IDLE && current != State::SUSPENDED)
+        return false;
+
+    running = true;
+    state = State::RUNNING;
+
+    // Started from the callback, the worker cannot be replaced while it runs and goes on itself
+    if (thread.joinable() && thread.get_id() == std::this_thread::get_id())
+    {
+        restarted = true;
+        // Cancelled meanwhile from another thread, which is waiting for the worker to stop
+        if (cancelled)
+            running = false;
+    }
+    else
+        thread = std::thread(&SolverSession::work, this);
+
+    return true;
+}
+
+void SolverSession::suspend()
+{
+    running = false;
+    wait();
+}
+
+void SolverSession::cancel()
+{
+    cancelled = true;
+    running = false;
+    wait();
+
+    State current{state};
+    if (current == State::IDLE || current == State::SUSPENDED)
+        state = State::CANCELLED;
+}
+
+void SolverSession::wait()
+{
+    // The callback may not wait for its own thread
+    if (thread.joinable() && thread.get_id() != std::this_thread::get_id())
+        thread.join();
+}
+
+void SolverSession::work()
+{
+    do
+    {
+        restarted = false;
+
+        State result{State::SOLVED};
+        auto startTime{std::chrono::steady_clock::now()};
+
+        try
+        {
+            if (!puzzle.isSolvable())
+                result = State::UNSOLVABLE;
+            else if (!search.resume(running, stats))
+                result = cancelled ? State::CANCELLED : State::SUSPENDED;
+        }
+        catch (...)
+        {
+            // Out of time or depth
+            result = State::FAILED;
+        }
+
+        elapsed += std::chrono::steady_clock::now() - startTime;
+        running = false;
+        state = result;
+
+        if (callback)
+            callback(*this);
+    } while (restarted);
+}
+
+void SolverSession::checkpoint(const std::string &path)
+{
+    bool wasRunning{state == State::RUNNING};
+    suspend();
+
+    std::ofstream out{path};
+
+    out << CHECKPOINT_HEADER << '\n';
+
+    out << puzzle.getDimension();
+    for (int n{0}; n < puzzle.getDimension() * puzzle.getDimension(); n++)
+        out << ' ' << puzzle.get(n);
+    out << '\n';
+
+    out << options.threshold << ' ' << options.maxDepth << ' ' << options.weight << ' ' << options.pruneLength;
+    for (Puzzle::Move move : options.order)
+        out << ' ' << move;
+    out << '\n';
+    out << stats.nodes << ' ' << stats.iterations << ' ' << stats.iterationsSaved << ' ' << elapsed.count() << '\n';
+
+    search.save(out);
+
+    out.close();
+    if (!out)
+        throw Search::CheckpointException();
+
+    if (wasRunning)
+        start();
+}
+
+std::unique_ptr<SolverSession> SolverSession::restore(const std::string &path, std::shared_ptr<const Puzzle::Heuristic> heuristic)
+{
+    std::ifstream in{path};
+
+    std::string header{};
+    std::getline(in, header);
+    if (header != CHECKPOINT_HEADER)
+        throw Search::CheckpointException();
+
+    int dimension{};
+    in >> dimension;
+    if (!in || dimension < 2 || dimension * dimension > 64)
+        throw Search::CheckpointException();
+
+    Puzzle puzzle{dimension * dimension - 1};
+    std::vector<int> tiles(dimension * dimension);
+    for (int &tile : tiles)
+        in >> tile;
+
+    if (!in || !puzzle.setTiles(tiles))
+        throw Search::CheckpointException();
+
+    Puzzle::Options options{};
+    unsigned int threshold{};
+    in >> threshold >> options.maxDepth >> options.weight >> options.pruneLength;
+    options.threshold = static_cast<Puzzle::Threshold>(threshold);
+    if (!in || threshold > Puzzle::Threshold::CONTROLLED || options.weight == 0)
+        throw Search::CheckpointException();
+
+    // A permutation of the moves, one left out would never be tried
+    bool seen[4]{};
+    for (Puzzle::Move &move : options.order)
+    {
+        unsigned int value{};
+        if (!(in >> value) || value > Puzzle::Move::RIGHT || seen[value])
+            throw Search::CheckpointException();
+        seen[value] = true;
+        move = static_cast<Puzzle::Move>(value);
+    }
+
+    std::unique_ptr<SolverSession> session{new SolverSession(puzzle, heuristic, options)};
+
+    long long elapsed{};
+    in >> session->stats.nodes >> session->stats.iterations >> session->stats.iterationsSaved >> elapsed;
+    session->elapsed = std::chrono::nanoseconds(elapsed);
+
+    session->search.load(in);
+    session->state = State::SUSPENDED;
+
+    return session;
+}
+
+SolverSession::State SolverSession::getState() const
+{
+    return state;
+}
+
+const Puzzle &SolverSession::getPuzzle() const
+{
+    return puzzle;
+}
+
+const std::vector<Puzzle::Move> &SolverSession::getSolution() const
+{
+    return search.solution();
+}
+
+const Puzzle::Stats &SolverSession::getStats() const
+{
+    return stats;
+}
+
+std::chrono::nanoseconds SolverSession::getElapsed() const
+{
+    return elapsed;
+}
@@ -0,0 +1,90 @@
+#include "stream.h"
+
+const std::chrono::milliseconds SolverStream::DEFAULT_SLICE_TIME{5};
+
+SolverStream::SolverStream(const Puzzle &puzzle, std::shared_ptr<const Puzzle::Heuristic> heuristic, const Puzzle::Options &options,
+                           unsigned long long slice, std::chrono::nanoseconds sliceTime)
+    : puzzle(puzzle), heuristic(heuristic), slice(slice), sliceTime(sliceTime), search(this->puzzle, *this->heuristic, options)
+{
+}
+
+bool SolverStream::next(Event &event)
+{
+    switch (state)
+    {
+    case State::SEARCHING:
+    {
+        if (!puzzle.isSolvable())
+        {
+            event = Event{Event::UNSOLVABLE};
+            state = State::FINISHED;
+            return true;
+        }
+
+        auto startTime{std::chrono::steady_clock::now()};
+        bool solved{};
+        try
+        {
+            solved = search.step(running, stats, slice, startTime + sliceTime);
+        }
+        catch (Puzzle::MaxThresholdException &)
+        {
+            state = State::FINISHED;
+        }
+        catch (Puzzle::DeadlineException &)
+        {
+            state = State::FINISHED;
+        }
+        elapsed += std::chrono::steady_clock::now() - startTime;
+
+        event = Event{Event::PROGRESS, search.getThreshold(), stats.nodes + search.getNodes()};
+
+        if (state == State::FINISHED)
+            event.type = Event::FAILED;
+        else if (solved)
+            state = State::MOVES;
+        else if (event.threshold != threshold)
+            event.type = Event::ITERATION;
+
+        threshold = event.threshold;
+        return true;
+    }
+
+    case State::MOVES:
+        event = Event{Event::MOVE, threshold, stats.nodes};
+
+        if (step < search.solution().size())
+        {
+            event.move = search.solution()[step++];
+            return true;
+        }
+
+        event.type = Event::SOLVED;
+        state = State::FINISHED;
+        return true;
+
+    case State::FINISHED:
+    default:
+        return false;
+    }
+}
+
+bool SolverStream::finished() const
+{
+    return state == State::FINISHED;
+}
+
+const Puzzle &SolverStream::getPuzzle() const
+{
+    return puzzle;
+}
+
+const Puzzle::Stats &SolverStream::getStats() const
+{
+    return stats;
+}
+
+std::chrono::nanoseconds SolverStream::getElapsed() const
+{
+    return elapsed;
+}
@@ -0,0 +1,212 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "batch.h"
+#include "test.h"
+
+namespace
+{
+    std::string temporary(const char *name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    void patch(const std::string &path, std::uint64_t position, std::uint64_t value)
+    {
+        std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+        file.seekp(position);
+        for (int n{0}; n < 8; n++)
+            file.put(static_cast<char>(value >> (8 * n)));
+    }
+
+    std::uint64_t read(const std::string &path, std::uint64_t position)
+    {
+        std::ifstream file{path, std::ios::binary};
+        file.seekg(position);
+
+        std::uint64_t value{0};
+        for (int n{0}; n < 8; n++)
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(file.get())) << (8 * n);
+        return value;
+    }
+
+    template <typename Call>
+    bool throwsFormat(Call call)
+    {
+        try
+        {
+            call();
+        }
+        catch (Batch::FormatException &)
+        {
+            return true;
+        }
+        return false;
+    }
+
+    template <typename Call>
+    bool throwsOutOfRange(Call call)
+    {
+        try
+        {
+            call();
+        }
+        catch (std::out_of_range &)
+        {
+            return true;
+        }
+        return false;
+    }
+}
+
+TEST(batch_readers_reject_indices_past_the_end)
+{
+    std::string instances{temporary("fifteen-test.fifi")}, solutions{temporary("fifteen-test.fifs")};
+
+    {
+        Batch::InstanceWriter writer{instances, 3};
+        writer.write(Puzzle{8});
+        writer.write(Puzzle{8});
+        writer.close();
+
+        Batch::SolutionWriter solutionWriter{solutions};
+        solutionWriter.write({Puzzle::Move::UP, Puzzle::Move::LEFT});
+        solutionWriter.write({Puzzle::Move::DOWN});
+        solutionWriter.close();
+    }
+
+    Batch::InstanceReader instanceReader{instances};
+    CHECK(instanceReader.size() == 2);
+    instanceReader.get(1);
+    CHECK(throwsOutOfRange([&]() { instanceReader.get(2); }));
+
+    Batch::SolutionReader solutionReader{solutions};
+    CHECK(solutionReader.get(1).size() == 1);
+    CHECK(throwsOutOfRange([&]() { solutionReader.get(2); }));
+    CHECK(throwsOutOfRange([&]() { solutionReader.length(2); }));
+
+    std::filesystem::remove(instances);
+    std::filesystem::remove(solutions);
+}
+
+TEST(batch_solution_reader_rejects_bad_offsets)
+{
+    std::string path{temporary("fifteen-test-offsets.fifs")};
+
+    {
+        Batch::SolutionWriter writer{path};
+        for (int n{0}; n < 3; n++)
+            writer.write({Puzzle::Move::UP, Puzzle::Move::DOWN, Puzzle::Move::UP, Puzzle::Move::DOWN});
+        writer.close();
+    }
+
+    // Offsets 0, 4, 8, 12 start at the index position in the header
+    std::uint64_t index{read(path, 16)};
+    Batch::SolutionReader{path};
+
+    // A middle offset far past the moves, with the last one still in place
+    patch(path, index + 8, 1 << 30);
+    CHECK(throwsFormat([&]() { Batch::SolutionReader{path}; }));
+
+    // Decreasing offsets
+    patch(path, index + 8, 10);
+    CHECK(throwsFormat([&]() { Batch::SolutionReader{path}; }));
+
+    // A count whose index would not fit in the file
+    patch(path, index + 8, 4);
+    Batch::SolutionReader{path};
+    patch(path, 8, ~std::uint64_t{0});
+    CHECK(throwsFormat([&]() { Batch::SolutionReader{path}; }));
+
+    std::filesystem::remove(path);
+}
+
+// Puzzles read back from an instance file are the ones written, in every encoding and size
+TEST(batch_instances_round_trip)
+{
+    std::string path{temporary("fifteen-test-instances")};
+
+    struct Format
+    {
+        int size;
+        Batch::Encoding encoding;
+    };
+
+    for (const Format &format : std::vector<Format>{
+             {3, Batch::Encoding::PACKED},
+             {8, Batch::Encoding::PACKED},
+             {15, Batch::Encoding::PACKED},
+             {24, Batch::Encoding::PACKED},
+             {35, Batch::Encoding::PACKED},
+             {3, Batch::Encoding::RANK},
+             {8, Batch::Encoding::RANK},
+             {15, Batch::Encoding::RANK},
+         })
+    {
+        std::vector<Puzzle> puzzles{};
+        {
+            Batch::InstanceWriter writer{path, Puzzle{format.size}.getDimension(), format.encoding};
+            for (int n{0}; n < 5000; n++)
+            {
+                puzzles.emplace_back(format.size);
+                writer.write(puzzles.back());
+            }
+            writer.close();
+        }
+
+        Batch::InstanceReader reader{path};
+        CHECK(reader.getDimension() == puzzles[0].getDimension());
+        CHECK(reader.getEncoding() == format.encoding);
+        CHECK(reader.size() == puzzles.size());
+        for (std::size_t n{0}; n < puzzles.size(); n++)
+            CHECK(reader.get(n) == puzzles[n]);
+    }
+
+    std::filesystem::remove(path);
+}
+
+// Solutions read back from a solution file are the ones written, unsolved puzzles included
+TEST(batch_solutions_round_trip)
+{
+    std::string path{temporary("fifteen-test-solutions")};
+
+    // Enough moves to flush the writer's buffers several times
+    std::vector<std::vector<Puzzle::Move>> solutions{};
+    std::vector<bool> solved{};
+    for (std::size_t n{0}; n < 8000; n++)
+    {
+        std::vector<Puzzle::Move> moves{};
+        for (std::size_t m{0}; m < (n * 7) % 251; m++)
+            moves.push_back(static_cast<Puzzle::Move>((n + (m * m)) % 4));
+
+        solved.push_back(n % 13 != 0);
+        solutions.push_back(solved.back() ? moves : std::vector<Puzzle::Move>{});
+    }
+
+    {
+        Batch::SolutionWriter writer{path};
+        for (std::size_t n{0}; n < solutions.size(); n++)
+        {
+            if (solved[n])
+                writer.write(solutions[n]);
+            else
+                writer.writeUnsolved();
+        }
+        writer.close();
+    }
+
+    Batch::SolutionReader reader{path};
+    CHECK(reader.size() == solutions.size());
+    for (std::size_t n{0}; n < solutions.size(); n++)
+    {
+        CHECK(reader.solved(n) == solved[n]);
+        CHECK(reader.length(n) == solutions[n].size());
+        CHECK(reader.get(n) == solutions[n]);
+    }
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,52 @@
+#include <cstdint>
+#include <filesystem>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "frontier.h"
+#include "test.h"
+
+namespace
+{
+    // Layer sizes of a whole space, in a scratch directory removed afterwards
+    std::vector<std::uint64_t> layers(const Frontier::Space &space, std::size_t memory, std::vector<std::string> *hardest)
+    {
+        std::filesystem::path dir{std::filesystem::temp_directory_path() / "fifteen-test-frontier"};
+        std::filesystem::create_directories(dir);
+
+        Frontier::BreadthFirstSearch search{space, dir.string(), 2, memory};
+        std::vector<std::uint64_t> counts{search.run(false)};
+
+        if (hardest)
+        {
+            for (std::uint64_t rank : search.hardest(counts.size() - 1, 10))
+                hardest->push_back(space.format(rank));
+        }
+        search.cleanup(counts.size() - 1);
+
+        CHECK(std::filesystem::is_empty(dir));
+        std::filesystem::remove_all(dir);
+        return counts;
+    }
+}
+
+// Known radii of the 2x3 and 3x3 spaces, the latter with a budget so small that runs are merged
+// in several passes
+TEST(frontier_search_finds_radius)
+{
+    std::vector<std::uint64_t> small{layers(Frontier::Space{2, 3, {1, 2, 3, 4, 5}}, std::size_t{256} << 20, nullptr)};
+    CHECK(small.size() - 1 == 21);
+    CHECK(std::accumulate(small.begin(), small.end(), std::uint64_t{0}) == 360);
+
+    std::vector<std::string> hardest{};
+    std::vector<std::uint64_t> eight{layers(Frontier::Space{3, 3, {1, 2, 3, 4, 5, 6, 7, 8}}, 1, &hardest)};
+    CHECK(eight.size() - 1 == 31);
+    CHECK(std::accumulate(eight.begin(), eight.end(), std::uint64_t{0}) == 181440);
+    CHECK(eight.back() == 2);
+    CHECK(hardest == (std::vector<std::string>{" 6  4  7\n 8  5  _\n 3  2  1\n", " 8  6  7\n 2  5  4\n 3  _  1\n"}));
+
+    // Only where tiles 1 to 3 and the blank are, every placement is reachable
+    std::vector<std::uint64_t> pattern{layers(Frontier::Space{3, 3, {1, 2, 3}}, std::size_t{256} << 20, nullptr)};
+    CHECK(std::accumulate(pattern.begin(), pattern.end(), std::uint64_t{0}) == 9 * 8 * 7 * 6);
+}
@@ -0,0 +1,128 @@
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "heuristic.h"
+#include "puzzle.h"
+#include "test.h"
+
+// Three or more tiles reversed in a line cost two moves per tile that has to leave it,
+// not per reversed pair (28 moves is the true distance of this board)
+TEST(linear_conflict_is_admissible)
+{
+    Puzzle puzzle{8};
+    puzzle.setTiles({0, 8, 7, 6, 5, 4, 3, 2, 1});
+
+    Heuristic::LinearConflictHeuristic linear{};
+    Heuristic::LinearConflictTableHeuristic table{};
+
+    CHECK(linear(puzzle) <= 28);
+    CHECK(table(puzzle) <= 28);
+}
+
+TEST(linear_conflict_matches_table)
+{
+    Heuristic::LinearConflictHeuristic linear{};
+    Heuristic::LinearConflictTableHeuristic table{};
+
+    // Tabled, computed on the stack and computed on the heap
+    for (int size : {8, 15, 24, 48, 99, 360})
+    {
+        for (int n{0}; n < 50; n++)
+        {
+            Puzzle puzzle{size};
+            unsigned int h{table(puzzle)};
+            CHECK(linear(puzzle) == h);
+
+            for (Puzzle::Move move : puzzle.validMoves())
+            {
+                Puzzle child{puzzle};
+                child.move(move);
+                CHECK(table.update(child, h, move) == linear(child));
+            }
+        }
+    }
+}
+
+namespace
+{
+    // Value tied to the exact board, so that the max taken over the reflection and the dual
+    // changes whenever either of them is not the board it should be
+    class FingerprintHeuristic : public Puzzle::Heuristic
+    {
+    public:
+        unsigned int operator()(const Puzzle &p) const { return p.getHash() % 1000003; }
+    };
+
+    // Visits every path up to depth moves from p depth first, as IDA* does, checking the
+    // values the per search instance updates against evaluating each state on its own
+    void checkPaths(const Puzzle::Heuristic &shared, const Puzzle::Heuristic &tracked, Puzzle &p, unsigned int h, int depth)
+    {
+        if (depth == 0)
+            return;
+
+        for (Puzzle::Move move : {Puzzle::Move::UP, Puzzle::Move::DOWN, Puzzle::Move::LEFT, Puzzle::Move::RIGHT})
+        {
+            if (!p.move(move))
+                continue;
+
+            unsigned int childH{tracked.update(p, h, move)};
+            CHECK(childH == shared(p));
+            checkPaths(shared, tracked, p, childH, depth - 1);
+
+            p.move(Puzzle::inverse(move));
+        }
+    }
+}
+
+TEST(reflection_dual_updates_along_paths)
+{
+    std::vector<std::shared_ptr<const Puzzle::Heuristic>> wrapped{
+        std::make_shared<FingerprintHeuristic>(),
+        std::make_shared<Heuristic::LinearConflictTableHeuristic>(),
+    };
+
+    for (int size : {8, 15})
+    {
+        for (int n{0}; n < 10; n++)
+        {
+            Heuristic::ReflectionDualHeuristic shared{wrapped[n % wrapped.size()]};
+
+            // Blank at or next to its goal position, so that the dual is looked up on some paths
+            Puzzle puzzle{size};
+            while (puzzle.move(Puzzle::Move::DOWN) || puzzle.move(Puzzle::Move::RIGHT))
+                ;
+            if (n % 4 >= 2)
+                puzzle.move(Puzzle::Move::UP);
+
+            std::unique_ptr<const Puzzle::Heuristic> tracked{shared.forSearch()};
+            CHECK(tracked != nullptr);
+
+            unsigned int h{(*tracked)(puzzle)};
+            CHECK(h == shared(puzzle));
+            checkPaths(shared, *tracked, puzzle, h, 6);
+        }
+    }
+}
+
+// Every search takes an instance of its own, so one shared by the threads of an engine
+// finds the same optimal length as the wrapped heuristic alone
+TEST(reflection_dual_is_shared_by_parallel_searches)
+{
+    Heuristic::LinearConflictTableHeuristic table{};
+    Heuristic::ReflectionDualHeuristic shared{std::make_shared<Heuristic::LinearConflictTableHeuristic>()};
+
+    Puzzle::Options options{};
+    options.engine = Puzzle::Engine::PARALLEL_WINDOW;
+    options.threads = 4;
+
+    for (int n{0}; n < 10; n++)
+    {
+        Puzzle puzzle{15};
+
+        std::atomic<bool> running{true}, sharedRunning{true};
+        Puzzle::Stats stats{}, sharedStats{};
+        std::size_t length{puzzle.solveMoves(table, running, Puzzle::Options{}, stats).size()};
+        CHECK(puzzle.solveMoves(shared, sharedRunning, options, sharedStats).size() == length);
+    }
+}
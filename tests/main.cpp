@@ -0,0 +1,51 @@
+// Runs every registered test case, or only those whose names contain the first argument.
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "test.h"
+
+std::vector<Test::Case> &Test::cases()
+{
+    static std::vector<Case> registered{};
+    return registered;
+}
+
+void Test::check(bool passed, const char *expression, const char *file, int line)
+{
+    if (passed)
+        return;
+
+    std::ostringstream message{};
+    message << file << ':' << line << ": CHECK(" << expression << ") failed";
+    throw std::runtime_error(message.str());
+}
+
+int main(int argc, char **argv)
+{
+    std::string filter{argc > 1 ? argv[1] : ""};
+    unsigned int run{0}, failed{0};
+
+    for (const Test::Case &test : Test::cases())
+    {
+        if (std::string{test.name}.find(filter) == std::string::npos)
+            continue;
+
+        run++;
+        try
+        {
+            test.run();
+            std::cout << "PASS " << test.name << '\n';
+        }
+        catch (std::exception &e)
+        {
+            failed++;
+            std::cout << "FAIL " << test.name << ": " << e.what() << '\n';
+        }
+    }
+
+    std::cout << run - failed << '/' << run << " passed\n";
+    return failed > 0 ? 1 : 0;
+}
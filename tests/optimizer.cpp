@@ -0,0 +1,105 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "heuristic.h"
+#include "optimizer.h"
+#include "test.h"
+
+namespace
+{
+    // Linear conflict that notes whether every board it valued was a permutation, as the
+    // heuristics that do not read goals off labels need
+    class PermutationHeuristic : public Puzzle::Heuristic
+    {
+    private:
+        ::Heuristic::LinearConflictTableHeuristic table{};
+
+    public:
+        mutable std::atomic<bool> permutations{true};
+
+        unsigned int operator()(const Puzzle &p) const
+        {
+            std::vector<int> tiles{};
+            for (int n{0}; n < p.getDimension() * p.getDimension(); n++)
+                tiles.push_back(p.get(n));
+
+            Puzzle copy{p};
+            if (!copy.setTiles(tiles))
+                permutations = false;
+
+            return table(p);
+        }
+    };
+
+    // Random walk of the blank, which wanders back and forth a lot
+    std::vector<Puzzle::Move> walk(const Puzzle &start, std::size_t length, unsigned int seed)
+    {
+        std::mt19937 random{seed};
+        Puzzle board{start};
+
+        std::vector<Puzzle::Move> moves{};
+        while (moves.size() < length)
+        {
+            std::vector<Puzzle::Move> valid{board.validMoves()};
+            Puzzle::Move move{valid[random() % valid.size()]};
+            board.move(move);
+            moves.push_back(move);
+        }
+        return moves;
+    }
+
+    Puzzle play(const Puzzle &start, const std::vector<Puzzle::Move> &moves)
+    {
+        Puzzle board{start};
+        for (Puzzle::Move move : moves)
+            board.move(move);
+        return board;
+    }
+}
+
+// Optimized paths lead to the same state, are never longer and keep the parity of the length
+TEST(optimizer_never_lengthens_paths)
+{
+    Search::PathOptimizer::Options options{};
+    options.window = 12;
+    options.budget = std::chrono::milliseconds{0};
+    Search::PathOptimizer optimizer{std::make_shared<Heuristic::LinearConflictTableHeuristic>(), options};
+
+    for (unsigned int seed{0}; seed < 10; seed++)
+    {
+        Puzzle start{15};
+        std::vector<Puzzle::Move> moves{walk(start, 150, seed)};
+
+        std::atomic<bool> running{true};
+        Search::PathOptimizer::Result result{optimizer.run(start, moves, running)};
+
+        CHECK(play(start, result.moves) == play(start, moves));
+        CHECK(result.moves.size() < moves.size());
+        CHECK(result.moves.size() % 2 == moves.size() % 2);
+        CHECK(result.moves.size() + result.cycleMoves + result.windowMoves == moves.size());
+    }
+}
+
+// Heuristics that need permutations are only given windows ending with the blank in the last cell
+TEST(optimizer_keeps_boards_permutations)
+{
+    Search::PathOptimizer::Options options{};
+    options.window = 12;
+    options.budget = std::chrono::milliseconds{0};
+
+    auto heuristic{std::make_shared<PermutationHeuristic>()};
+    Search::PathOptimizer optimizer{heuristic, options};
+
+    Puzzle start{15};
+    std::vector<Puzzle::Move> moves{walk(start, 150, 1)};
+
+    std::atomic<bool> running{true};
+    Search::PathOptimizer::Result result{optimizer.run(start, moves, running)};
+
+    CHECK(heuristic->permutations);
+    CHECK(play(start, result.moves) == play(start, moves));
+    CHECK(result.moves.size() <= moves.size());
+}
@@ -0,0 +1,17 @@
+#include <atomic>
+
+#include "portfolio.h"
+#include "test.h"
+
+// Pairwise linear conflict overestimates this board (32 against 28), the portfolio must not
+TEST(portfolio_solution_is_optimal)
+{
+    Puzzle puzzle{8};
+    puzzle.setTiles({0, 8, 7, 6, 5, 4, 3, 2, 1});
+
+    Search::PortfolioSearch portfolio{};
+    std::atomic<bool> running{true};
+    Search::PortfolioSearch::Result result{portfolio.run(puzzle, running)};
+
+    CHECK(result.moves.size() == 28);
+}
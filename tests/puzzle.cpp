@@ -0,0 +1,98 @@
+#include <functional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "puzzle.h"
+#include "test.h"
+
+namespace
+{
+    // Hash of the same board computed from scratch
+    std::uint64_t rehashed(const Puzzle &p)
+    {
+        std::vector<int> tiles{};
+        for (int n{0}; n < p.getDimension() * p.getDimension(); n++)
+            tiles.push_back(p.get(n));
+
+        Puzzle copy{8};
+        copy.setTiles(tiles);
+        return copy.getHash();
+    }
+}
+
+// Lines of tiles are read as a whole square permutation or not at all
+TEST(puzzle_parses_tiles)
+{
+    Puzzle puzzle{8};
+
+    CHECK(puzzle.parseTiles(" 1 2 3\t4 5 6 7 0 8 "));
+    CHECK(puzzle.getDimension() == 3);
+    CHECK(puzzle.getBlank() == 7);
+
+    CHECK(puzzle.parseTiles("2 1 3 0"));
+    CHECK(puzzle.getDimension() == 2);
+
+    CHECK(!puzzle.parseTiles("1 2 3 4 5 6 7 8"));
+    CHECK(!puzzle.parseTiles("1 2 3 4 5 6 7 7 0"));
+    CHECK(!puzzle.parseTiles("1 2 3 4 5 6 7 0 8 x"));
+    CHECK(!puzzle.parseTiles(""));
+
+    CHECK(std::string(Puzzle::MOVE_NAMES, 4) == "UDLR");
+}
+
+// The hash kept up to date by every change equals the one of the board computed from scratch
+TEST(puzzle_hash_follows_changes)
+{
+    std::mt19937 random{42};
+
+    for (int size : {8, 15, 24})
+    {
+        Puzzle puzzle{size};
+        int cells{puzzle.getDimension() * puzzle.getDimension()};
+
+        for (int n{0}; n < 500; n++)
+        {
+            std::vector<Puzzle::Move> valid{puzzle.validMoves()};
+            puzzle.move(valid[random() % valid.size()]);
+            CHECK(puzzle.getHash() == rehashed(puzzle));
+        }
+
+        // Moving the blank onto a cell
+        for (int n{0}; n < 50; n++)
+        {
+            puzzle.set(static_cast<int>(random() % cells), 0);
+            CHECK(puzzle.getHash() == rehashed(puzzle));
+        }
+
+        // Swapping two tiles cell by cell
+        for (int n{0}; n < 50; n++)
+        {
+            int a{static_cast<int>(random() % cells)}, b{static_cast<int>(random() % cells)};
+            int tileA{puzzle.get(a)}, tileB{puzzle.get(b)};
+            puzzle.put(a, tileB);
+            puzzle.put(b, tileA);
+            CHECK(puzzle.getHash() == rehashed(puzzle));
+        }
+
+        Puzzle copy{puzzle};
+        CHECK(copy == puzzle);
+        CHECK(std::hash<Puzzle>{}(copy) == puzzle.getHash());
+
+        Puzzle moved{std::move(copy)};
+        CHECK(moved.getHash() == puzzle.getHash());
+    }
+
+    Puzzle small{8};
+    Puzzle packed{8};
+    for (int n{0}; n < 100; n++)
+    {
+        std::vector<Puzzle::Move> valid{small.validMoves()};
+        small.move(valid[random() % valid.size()]);
+
+        packed.unpack(small.pack());
+        CHECK(packed == small);
+        CHECK(packed.getHash() == rehashed(small));
+    }
+}
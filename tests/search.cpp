@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "heuristic.h"
+#include "puzzle.h"
+#include "test.h"
+
+namespace
+{
+    Puzzle board(const std::vector<int> &tiles)
+    {
+        Puzzle puzzle{8};
+        puzzle.setTiles(tiles);
+        return puzzle;
+    }
+
+    bool solves(const Puzzle &puzzle, const std::vector<Puzzle::Move> &moves)
+    {
+        Puzzle played{puzzle};
+        for (Puzzle::Move move : moves)
+        {
+            if (!played.move(move))
+                return false;
+        }
+        return played.isSolved();
+    }
+
+    // Distance of every 3x3 board from the goal, by breadth-first search over packed boards
+    const std::unordered_map<std::uint64_t, unsigned int> &distances()
+    {
+        static const std::unordered_map<std::uint64_t, unsigned int> found{[]()
+                                                                           {
+                                                                               std::unordered_map<std::uint64_t, unsigned int> distance{};
+                                                                               Puzzle goal{board({1, 2, 3, 4, 5, 6, 7, 8, 0})};
+                                                                               std::deque<std::uint64_t> queue{goal.pack()};
+                                                                               distance[goal.pack()] = 0;
+
+                                                                               Puzzle p{goal};
+                                                                               while (!queue.empty())
+                                                                               {
+                                                                                   std::uint64_t packed{queue.front()};
+                                                                                   queue.pop_front();
+                                                                                   p.unpack(packed);
+
+                                                                                   for (Puzzle::Move move : p.validMoves())
+                                                                                   {
+                                                                                       Puzzle child{p};
+                                                                                       child.move(move);
+                                                                                       if (distance.emplace(child.pack(), distance[packed] + 1).second)
+                                                                                           queue.push_back(child.pack());
+                                                                                   }
+                                                                               }
+                                                                               return distance;
+                                                                           }()};
+        return found;
+    }
+
+    // Every count-th solvable 3x3 board in a fixed order, spread over all distances
+    std::vector<Puzzle> samples(std::size_t count)
+    {
+        std::vector<std::uint64_t> packed{};
+        for (const auto &[board, distance] : distances())
+            packed.push_back(board);
+        std::sort(packed.begin(), packed.end());
+
+        std::vector<Puzzle> puzzles{};
+        for (std::size_t n{0}; n < packed.size(); n += packed.size() / count)
+        {
+            Puzzle p{board({1, 2, 3, 4, 5, 6, 7, 8, 0})};
+            p.unpack(packed[n]);
+            puzzles.push_back(p);
+        }
+        return puzzles;
+    }
+
+    // Boards of the 3x3 samples solved as far as the breadth-first search says and 4x4 boards
+    // as far as serial IDA* does, all by engine itself
+    void checkOptimal(Puzzle::Engine engine)
+    {
+        Heuristic::LinearConflictTableHeuristic heuristic{};
+
+        std::vector<std::pair<Puzzle, unsigned int>> cases{};
+        for (const Puzzle &puzzle : samples(200))
+            cases.emplace_back(puzzle, distances().at(puzzle.pack()));
+
+        std::mt19937 random{15};
+        for (int n{0}; n < 20; n++)
+        {
+            Puzzle puzzle{15};
+            puzzle.setTiles({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0});
+            for (int step{0}; step < 60; step++)
+            {
+                std::vector<Puzzle::Move> valid{puzzle.validMoves()};
+                puzzle.move(valid[random() % valid.size()]);
+            }
+
+            std::atomic<bool> running{true};
+            Puzzle::Stats stats{};
+            cases.emplace_back(puzzle, puzzle.solveMoves(heuristic, running, Puzzle::Options{}, stats).size());
+        }
+
+        for (const auto &[puzzle, length] : cases)
+        {
+            Puzzle::Options options{};
+            options.engine = engine;
+
+            std::atomic<bool> running{true};
+            Puzzle::Stats stats{};
+            std::vector<Puzzle::Move> moves{puzzle.solveMoves(heuristic, running, options, stats)};
+
+            CHECK(stats.engine == engine);
+            CHECK(moves.size() == length);
+            CHECK(solves(puzzle, moves));
+        }
+    }
+}
+
+// Weighted thresholds pass the maximum depth, a goal found there must not be recorded past the stack
+TEST(weighted_search_respects_max_depth)
+{
+    Heuristic::ManhattanDistanceHeuristic manhattan{};
+    Puzzle puzzle{board({1, 2, 3, 4, 5, 6, 0, 7, 8})};
+
+    for (unsigned int maxDepth : {1u, 2u, 3u, 5u})
+    {
+        Puzzle::Options options{};
+        options.maxDepth = maxDepth;
+        options.weight = 3;
+
+        std::atomic<bool> running{true};
+        Puzzle::Stats stats{};
+        try
+        {
+            std::vector<Puzzle::Move> moves{puzzle.solveMoves(manhattan, running, options, stats)};
+            CHECK(moves.size() <= maxDepth);
+            CHECK(solves(puzzle, moves));
+        }
+        catch (Puzzle::MaxThresholdException &)
+        {
+            CHECK(maxDepth < 2);
+        }
+    }
+}
+
+// Engines that cannot solve a puzzle leave it to serial IDA*, which the stats must tell
+TEST(engine_fallback_is_reported)
+{
+    Heuristic::LinearConflictTableHeuristic heuristic{};
+    Puzzle small{board({1, 2, 3, 4, 5, 6, 0, 7, 8})};
+    Puzzle large{board({1, 2, 3, 4, 5, 6, 0, 7, 8})};
+    std::vector<int> tiles(25);
+    for (int n{0}; n < 24; n++)
+        tiles[n] = n + 1;
+    large.setTiles(tiles);
+    large.move(Puzzle::Move::UP);
+    large.move(Puzzle::Move::LEFT);
+
+    struct Case
+    {
+        const Puzzle &puzzle;
+        Puzzle::Engine engine;
+        unsigned int weight;
+        std::size_t memoryLimit;
+        Puzzle::Engine expected;
+    };
+
+    const std::size_t LIMIT{Puzzle::Options{}.memoryLimit};
+    for (const Case &c : std::vector<Case>{
+             {small, Puzzle::Engine::IDA_STAR, 1, LIMIT, Puzzle::Engine::IDA_STAR},
+             {small, Puzzle::Engine::FRINGE, 1, LIMIT, Puzzle::Engine::FRINGE},
+             {large, Puzzle::Engine::FRINGE, 1, LIMIT, Puzzle::Engine::IDA_STAR},
+             {small, Puzzle::Engine::A_STAR, 1, LIMIT, Puzzle::Engine::A_STAR},
+             {large, Puzzle::Engine::A_STAR, 1, LIMIT, Puzzle::Engine::IDA_STAR},
+             {small, Puzzle::Engine::A_STAR, 1, 0, Puzzle::Engine::IDA_STAR},
+             {small, Puzzle::Engine::PARALLEL_WINDOW, 1, LIMIT, Puzzle::Engine::PARALLEL_WINDOW},
+             {small, Puzzle::Engine::PARALLEL_WINDOW, 2, LIMIT, Puzzle::Engine::IDA_STAR},
+         })
+    {
+        Puzzle::Options options{};
+        options.engine = c.engine;
+        options.weight = c.weight;
+        options.memoryLimit = c.memoryLimit;
+
+        std::atomic<bool> running{true};
+        Puzzle::Stats stats{};
+        std::vector<Puzzle::Move> moves{c.puzzle.solveMoves(heuristic, running, options, stats)};
+
+        CHECK(solves(c.puzzle, moves));
+        CHECK(stats.engine == c.expected);
+    }
+}
+
+// Controlled thresholds skip iterations but still find optimal solutions
+TEST(controlled_thresholds_stay_optimal)
+{
+    Heuristic::MisplacedTilesHeuristic misplaced{};
+    unsigned int saved{0};
+
+    for (const Puzzle &puzzle : samples(50))
+    {
+        Puzzle::Options minimum{}, controlled{};
+        controlled.threshold = Puzzle::Threshold::CONTROLLED;
+
+        // Solving clears running
+        std::atomic<bool> minimumRunning{true}, controlledRunning{true};
+        Puzzle::Stats minimumStats{}, controlledStats{};
+        std::vector<Puzzle::Move> plain{puzzle.solveMoves(misplaced, minimumRunning, minimum, minimumStats)};
+        std::vector<Puzzle::Move> moves{puzzle.solveMoves(misplaced, controlledRunning, controlled, controlledStats)};
+
+        unsigned int distance{distances().at(puzzle.pack())};
+        CHECK(plain.size() == distance);
+        CHECK(moves.size() == distance);
+        CHECK(solves(puzzle, moves));
+
+        // At most one branch and bound pass more than the iterations plain IDA* ran
+        CHECK(controlledStats.iterations <= minimumStats.iterations + 1);
+        saved += controlledStats.iterationsSaved;
+    }
+
+    CHECK(saved > 0);
+}
+
+// Pruning the sequences the move automaton recognises leaves an optimal path to every board
+TEST(automaton_pruning_stays_optimal)
+{
+    Heuristic::ManhattanDistanceHeuristic manhattan{};
+    unsigned long long unprunedNodes{0}, prunedNodes{0};
+
+    for (const Puzzle &puzzle : samples(200))
+    {
+        unsigned int distance{distances().at(puzzle.pack())};
+
+        for (unsigned int pruneLength : {2u, 6u, 10u})
+        {
+            Puzzle::Options options{};
+            options.pruneLength = pruneLength;
+
+            std::atomic<bool> running{true};
+            Puzzle::Stats stats{};
+            std::vector<Puzzle::Move> moves{puzzle.solveMoves(manhattan, running, options, stats)};
+
+            CHECK(moves.size() == distance);
+            CHECK(solves(puzzle, moves));
+
+            if (pruneLength == 2)
+                unprunedNodes += stats.nodes;
+            else if (pruneLength == 10)
+                prunedNodes += stats.nodes;
+        }
+    }
+
+    CHECK(prunedNodes < unprunedNodes);
+}
+
+TEST(fringe_search_is_optimal)
+{
+    checkOptimal(Puzzle::Engine::FRINGE);
+}
+
+TEST(a_star_is_optimal)
+{
+    checkOptimal(Puzzle::Engine::A_STAR);
+}
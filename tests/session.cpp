@@ -0,0 +1,165 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "heuristic.h"
+#include "session.h"
+#include "test.h"
+
+namespace
+{
+    // Solvable and far from solved for misplaced tiles, which barely guides the search
+    Puzzle transposedGoal()
+    {
+        std::vector<int> tiles(25);
+        for (int n{0}; n < 24; n++)
+            tiles[n] = ((n % 5) * 5) + (n / 5) + 1;
+        tiles[24] = 0;
+
+        Puzzle puzzle{24};
+        puzzle.setTiles(tiles);
+        return puzzle;
+    }
+
+    template <typename Call>
+    std::chrono::nanoseconds timed(Call call)
+    {
+        auto startTime{std::chrono::steady_clock::now()};
+        call();
+        return std::chrono::steady_clock::now() - startTime;
+    }
+}
+
+// Suspending or cancelling a running session stops its worker within 10 ms
+TEST(session_stops_within_latency)
+{
+    const std::chrono::milliseconds LATENCY{10};
+
+    SolverSession session{transposedGoal(), std::make_shared<Heuristic::MisplacedTilesHeuristic>()};
+
+    for (int n{0}; n < 5; n++)
+    {
+        CHECK(session.start());
+        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+        CHECK(timed([&]()
+                    { session.suspend(); }) < LATENCY);
+        CHECK(session.getState() == SolverSession::State::SUSPENDED);
+    }
+
+    CHECK(session.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+    CHECK(timed([&]()
+                { session.cancel(); }) < LATENCY);
+    CHECK(session.getState() == SolverSession::State::CANCELLED);
+}
+
+// A search checkpointed and restored over and over ends with the solution of an uninterrupted one
+TEST(session_resumes_from_checkpoints)
+{
+    auto heuristic{std::make_shared<Heuristic::MisplacedTilesHeuristic>()};
+    std::string path{(std::filesystem::temp_directory_path() / "fifteen-test-checkpoint").string()};
+
+    Puzzle puzzle{8};
+    puzzle.setTiles({0, 8, 7, 6, 5, 4, 3, 2, 1});
+
+    SolverSession uninterrupted{puzzle, heuristic};
+    uninterrupted.start();
+    uninterrupted.wait();
+    CHECK(uninterrupted.getState() == SolverSession::State::SOLVED);
+
+    auto session{std::make_unique<SolverSession>(puzzle, heuristic)};
+    int restores{0};
+    while (session->start())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        session->suspend();
+        if (session->getState() != SolverSession::State::SUSPENDED)
+            break;
+
+        session->checkpoint(path);
+        session = SolverSession::restore(path, heuristic);
+        restores++;
+    }
+
+    std::filesystem::remove(path);
+
+    CHECK(restores > 0);
+    CHECK(session->getState() == SolverSession::State::SOLVED);
+    CHECK(session->getSolution() == uninterrupted.getSolution());
+    CHECK(session->getStats().nodes == uninterrupted.getStats().nodes);
+}
+
+// A callback may start its session again, which then runs to the end on the same worker
+TEST(session_restarts_from_callback)
+{
+    Puzzle puzzle{8};
+    puzzle.setTiles({0, 8, 7, 6, 5, 4, 3, 2, 1});
+
+    SolverSession session{puzzle, std::make_shared<Heuristic::MisplacedTilesHeuristic>()};
+    int stops{0};
+    session.setCallback([&](SolverSession &stopped)
+                        {
+                            stops++;
+                            if (stopped.getState() == SolverSession::State::SUSPENDED)
+                                CHECK(stopped.start()); });
+
+    // Suspended long before the solution is found, the worker stops twice
+    CHECK(session.start());
+    session.suspend();
+
+    CHECK(stops == 2);
+    CHECK(session.getState() == SolverSession::State::SOLVED);
+    CHECK(session.getSolution().size() == 28);
+}
+
+// Checkpoints whose move order is not a permutation of the moves are rejected
+TEST(session_rejects_partial_move_orders)
+{
+    std::string path{(std::filesystem::temp_directory_path() / "fifteen-test-order").string()};
+
+    Puzzle puzzle{8};
+    puzzle.setTiles({0, 8, 7, 6, 5, 4, 3, 2, 1});
+
+    SolverSession session{puzzle, std::make_shared<Heuristic::MisplacedTilesHeuristic>()};
+    session.checkpoint(path);
+
+    std::vector<std::string> lines{};
+    {
+        std::ifstream in{path};
+        for (std::string line{}; std::getline(in, line);)
+            lines.push_back(line);
+    }
+
+    // Options line: threshold, maximum depth, weight, prune length and the four moves
+    std::istringstream options{lines[2]};
+    std::string threshold{}, maxDepth{}, weight{}, pruneLength{};
+    options >> threshold >> maxDepth >> weight >> pruneLength;
+    lines[2] = threshold + ' ' + maxDepth + ' ' + weight + ' ' + pruneLength + " 0 0 0 0";
+
+    {
+        std::ofstream out{path};
+        for (const std::string &line : lines)
+            out << line << '\n';
+    }
+
+    bool rejected{false};
+    try
+    {
+        SolverSession::restore(path, std::make_shared<Heuristic::MisplacedTilesHeuristic>());
+    }
+    catch (Search::CheckpointException &)
+    {
+        rejected = true;
+    }
+
+    std::filesystem::remove(path);
+
+    CHECK(rejected);
+}
@@ -0,0 +1,39 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "heuristic.h"
+#include "stream.h"
+#include "test.h"
+
+// A slice with no node limit on a board the heuristic takes very long to solve must still end
+// at about the slice time, as the GUI runs slices between its events
+TEST(stream_slices_are_capped_by_time)
+{
+    // The transposed goal is solvable and misplaced tiles barely guides the search towards it
+    std::vector<int> tiles(25);
+    for (int n{0}; n < 24; n++)
+        tiles[n] = ((n % 5) * 5) + (n / 5) + 1;
+    tiles[24] = 0;
+
+    Puzzle puzzle{24};
+    puzzle.setTiles(tiles);
+
+    const std::chrono::milliseconds sliceTime{5};
+    SolverStream stream{puzzle, std::make_shared<Heuristic::MisplacedTilesHeuristic>(), Puzzle::Options{}, ~0ull, sliceTime};
+
+    std::chrono::nanoseconds longest{};
+    for (int n{0}; n < 20; n++)
+    {
+        auto startTime{std::chrono::steady_clock::now()};
+        SolverStream::Event event{};
+        CHECK(stream.next(event));
+        longest = std::max<std::chrono::nanoseconds>(longest, std::chrono::steady_clock::now() - startTime);
+
+        CHECK(event.type == SolverStream::Event::PROGRESS || event.type == SolverStream::Event::ITERATION);
+    }
+
+    // Leaves room for the scheduler, an uncapped slice would not return before the board is solved
+    CHECK(longest < sliceTime + std::chrono::milliseconds{20});
+}
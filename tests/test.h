@@ -0,0 +1,34 @@
+#ifndef FIFTEEN_TEST_H
+#define FIFTEEN_TEST_H
+
+#include <vector>
+
+// Minimal test registry: TEST(name) defines a case that runs with every other one in
+// fifteen-test, CHECK(expression) fails the case it is in when the expression is false.
+namespace Test
+{
+    struct Case
+    {
+        const char *name;
+        void (*run)();
+    };
+
+    std::vector<Case> &cases();
+
+    struct Register
+    {
+        Register(const char *name, void (*run)()) { cases().push_back({name, run}); }
+    };
+
+    // Throws to end the current case
+    void check(bool passed, const char *expression, const char *file, int line);
+}
+
+#define TEST(name)                                             \
+    static void test_##name();                                 \
+    static Test::Register register_##name{#name, test_##name}; \
+    static void test_##name()
+
+#define CHECK(expression) Test::check((expression), #expression, __FILE__, __LINE__)
+
+#endif
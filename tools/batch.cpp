@@ -0,0 +1,224 @@
+// Converts batches of puzzles to and from the binary batch format and solves them.
+//
+//   pack [--rank] FILE      Reads puzzles from standard input, one per line as the tiles in
+//                           row-major order with 0 for the blank, into an instance file
+//   solve [--weight W] FILE SOLUTIONS
+//                           Solves every puzzle of an instance file into a solution file,
+//                           optimally unless weighted
+//   optimize [--window N] [--budget MS] FILE SOLUTIONS OUTPUT
+//                           Shortens every solution of a solution file
+//   show FILE [SOLUTIONS]   Prints the puzzles of an instance file, and their solutions
+//
+// All puzzles of an instance file share the dimension of the first.
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "batch.h"
+#include "heuristic.h"
+#include "optimizer.h"
+
+namespace
+{
+    const char USAGE[] = "Usage: fifteen-batch pack [--rank] FILE < puzzles\n"
+                         "       fifteen-batch solve [--weight W] FILE SOLUTIONS\n"
+                         "       fifteen-batch optimize [--window N] [--budget MS] FILE SOLUTIONS OUTPUT\n"
+                         "       fifteen-batch show FILE [SOLUTIONS]\n";
+
+    int pack(const std::string &path, Batch::Encoding encoding)
+    {
+        std::unique_ptr<Batch::InstanceWriter> writer{};
+        int dimension{};
+
+        Puzzle puzzle{15};
+        std::string line{};
+        std::size_t count{0}, skipped{0};
+
+        while (std::getline(std::cin, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            if (!puzzle.parseTiles(line) || (writer && puzzle.getDimension() != dimension))
+            {
+                skipped++;
+                continue;
+            }
+
+            if (!writer)
+            {
+                dimension = puzzle.getDimension();
+                writer = std::make_unique<Batch::InstanceWriter>(path, dimension, encoding);
+            }
+
+            writer->write(puzzle);
+            count++;
+        }
+
+        if (!writer)
+        {
+            std::cerr << "No puzzles read\n";
+            return 1;
+        }
+        writer->close();
+
+        std::cout << count << " puzzles packed, " << skipped << " skipped\n";
+        return 0;
+    }
+
+    int solve(const std::string &path, const std::string &solutionPath, unsigned int weight)
+    {
+        Batch::InstanceReader reader{path};
+        Batch::SolutionWriter writer{solutionPath};
+
+        Heuristic::LinearConflictTableHeuristic heuristic{};
+        Puzzle::Options options{};
+        options.weight = weight;
+
+        Puzzle puzzle{reader.getDimension() * reader.getDimension() - 1};
+        std::size_t solved{0};
+
+        for (std::uint64_t n{0}; n < reader.size(); n++)
+        {
+            reader.get(n, puzzle);
+
+            try
+            {
+                std::atomic<bool> running{true};
+                Puzzle::Stats stats{};
+                writer.write(puzzle.solveMoves(heuristic, running, options, stats));
+                solved++;
+            }
+            catch (Puzzle::UnsolvableException &)
+            {
+                writer.writeUnsolved();
+            }
+            catch (Puzzle::MaxThresholdException &)
+            {
+                writer.writeUnsolved();
+            }
+        }
+        writer.close();
+
+        std::cout << solved << " of " << reader.size() << " puzzles solved\n";
+        return 0;
+    }
+
+    int optimize(const std::string &path, const std::string &solutionPath, const std::string &outputPath, const Search::PathOptimizer::Options &options)
+    {
+        Batch::InstanceReader reader{path};
+        Batch::SolutionReader solutions{solutionPath};
+        Batch::SolutionWriter writer{outputPath};
+
+        Search::PathOptimizer optimizer{std::make_shared<Heuristic::LinearConflictTableHeuristic>(), options};
+        std::atomic<bool> running{true};
+
+        Puzzle puzzle{reader.getDimension() * reader.getDimension() - 1};
+        std::uint64_t before{0}, after{0};
+
+        for (std::uint64_t n{0}; n < std::min(reader.size(), solutions.size()); n++)
+        {
+            if (!solutions.solved(n))
+            {
+                writer.writeUnsolved();
+                continue;
+            }
+
+            reader.get(n, puzzle);
+            std::vector<Puzzle::Move> moves{solutions.get(n)};
+            Search::PathOptimizer::Result result{optimizer.run(puzzle, moves, running)};
+
+            before += moves.size();
+            after += result.moves.size();
+            writer.write(result.moves);
+        }
+        writer.close();
+
+        std::cout << before << " moves shortened to " << after << '\n';
+        return 0;
+    }
+
+    int show(const std::string &path, const std::string &solutionPath)
+    {
+        Batch::InstanceReader reader{path};
+        std::unique_ptr<Batch::SolutionReader> solutions{};
+        if (!solutionPath.empty())
+            solutions = std::make_unique<Batch::SolutionReader>(solutionPath);
+
+        Puzzle puzzle{reader.getDimension() * reader.getDimension() - 1};
+
+        for (std::uint64_t n{0}; n < reader.size(); n++)
+        {
+            reader.get(n, puzzle);
+
+            for (int i{0}; i < puzzle.getSize() + 1; i++)
+                std::cout << (i > 0 ? " " : "") << puzzle.get(i);
+
+            if (solutions && n < solutions->size())
+            {
+                std::cout << '\t';
+                if (!solutions->solved(n))
+                    std::cout << "unsolved";
+                for (Puzzle::Move move : solutions->get(n))
+                    std::cout << Puzzle::MOVE_NAMES[move];
+            }
+            std::cout << '\n';
+        }
+
+        return 0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    unsigned int weight{1};
+    Search::PathOptimizer::Options optimizerOptions{};
+
+    try
+    {
+        // Options come right after the command
+        while (args.size() >= 3 && args[1].compare(0, 2, "--") == 0 && args[1] != "--rank")
+        {
+            if (args[0] == "solve" && args[1] == "--weight")
+                weight = std::max<unsigned long>(1, std::stoul(args[2]));
+            else if (args[0] == "optimize" && args[1] == "--window")
+                optimizerOptions.window = std::stoul(args[2]);
+            else if (args[0] == "optimize" && args[1] == "--budget")
+                optimizerOptions.budget = std::chrono::milliseconds{std::stoul(args[2])};
+            else
+                break;
+
+            args.erase(args.begin() + 1, args.begin() + 3);
+        }
+
+        if (args.size() == 2 && args[0] == "pack")
+            return pack(args[1], Batch::Encoding::PACKED);
+        if (args.size() == 3 && args[0] == "pack" && args[1] == "--rank")
+            return pack(args[2], Batch::Encoding::RANK);
+        if (args.size() == 3 && args[0] == "solve")
+            return solve(args[1], args[2], weight);
+        if (args.size() == 4 && args[0] == "optimize")
+            return optimize(args[1], args[2], args[3], optimizerOptions);
+        if (args.size() >= 2 && args.size() <= 3 && args[0] == "show")
+            return show(args[1], args.size() == 3 ? args[2] : "");
+    }
+    catch (Batch::FormatException &e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    catch (const std::logic_error &)
+    {
+        // Option values that are not numbers
+    }
+
+    std::cerr << USAGE;
+    return 1;
+}
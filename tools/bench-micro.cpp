@@ -0,0 +1,390 @@
+// Microbenchmarks of the puzzle primitives and heuristics.
+//
+// Each primitive is timed over enough iterations to run for the given time, repeated, and the
+// fastest run is reported as time per operation. Where the kernel allows it, hardware counters
+// of cycles, instructions, branch misses and cache misses are read around the same run via
+// perf_event_open; otherwise only time is reported.
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "heuristic.h"
+#include "puzzle.h"
+
+namespace
+{
+    const char USAGE[] = "Usage: fifteen-bench-micro [options]\n"
+                         "  --size N       Puzzle size, e.g. 8 or 15 (default 15)\n"
+                         "  --time MS      Time per run in milliseconds (default 200)\n"
+                         "  --filter TEXT  Only run benchmarks whose name contains TEXT\n";
+
+    const int REPEATS{5};
+    // States cycled through, so that branches do not settle on a single board
+    const std::size_t POOL_SIZE{256};
+
+    // Keeps the compiler from optimizing a result away
+    template <typename T>
+    void keep(const T &value)
+    {
+#if defined(__GNUC__)
+        asm volatile(""
+                     :
+                     : "r,m"(value)
+                     : "memory");
+#else
+        static volatile T sink{};
+        sink = value;
+#endif
+    }
+
+    class Counters
+    {
+    public:
+        static const int COUNT{4};
+        static const char *const NAMES[COUNT];
+
+        using Values = std::array<double, COUNT>;
+
+    private:
+        std::array<int, COUNT> fds{};
+        std::string error{};
+
+    public:
+        Counters()
+        {
+            fds.fill(-1);
+
+#ifdef __linux__
+            const std::array<std::uint64_t, COUNT> events{
+                PERF_COUNT_HW_CPU_CYCLES,
+                PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_BRANCH_MISSES,
+                PERF_COUNT_HW_CACHE_MISSES,
+            };
+
+            // Opened one by one rather than as a group, so one missing counter does not take the others
+            for (int n{0}; n < COUNT; n++)
+            {
+                perf_event_attr attr{};
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = events[n];
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                fds[n] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+                if (fds[n] < 0 && error.empty())
+                    error = std::strerror(errno);
+            }
+#else
+            error = "not supported on this platform";
+#endif
+        }
+
+        ~Counters()
+        {
+#ifdef __linux__
+            for (int fd : fds)
+            {
+                if (fd >= 0)
+                    close(fd);
+            }
+#endif
+        }
+
+        Counters(const Counters &) = delete;
+        Counters &operator=(const Counters &) = delete;
+
+        bool available() const
+        {
+            for (int fd : fds)
+            {
+                if (fd >= 0)
+                    return true;
+            }
+            return false;
+        }
+
+        // Reason the first unavailable counter could not be opened, empty if all were
+        const std::string &getError() const
+        {
+            return error;
+        }
+
+        void start()
+        {
+#ifdef __linux__
+            for (int fd : fds)
+            {
+                if (fd < 0)
+                    continue;
+
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        // Counts since start, NaN for counters that are unavailable or did not run
+        Values stop()
+        {
+            Values values{};
+            values.fill(std::numeric_limits<double>::quiet_NaN());
+
+#ifdef __linux__
+            for (int n{0}; n < COUNT; n++)
+            {
+                if (fds[n] >= 0)
+                    ioctl(fds[n], PERF_EVENT_IOC_DISABLE, 0);
+            }
+
+            for (int n{0}; n < COUNT; n++)
+            {
+                // Value, time enabled and time running
+                std::uint64_t data[3]{};
+                if (fds[n] < 0 || read(fds[n], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+                    continue;
+
+                // Scale up counts of counters the kernel multiplexed
+                values[n] = static_cast<double>(data[0]) * data[1] / data[2];
+            }
+#endif
+
+            return values;
+        }
+    };
+
+    const char *const Counters::NAMES[COUNT]{"cycles", "instr", "br-miss", "cache-miss"};
+
+    struct Benchmark
+    {
+        std::string name;
+        // Runs the primitive the given number of times
+        std::function<void(std::size_t)> run;
+    };
+
+    struct Result
+    {
+        double nanoseconds;
+        Counters::Values counts;
+    };
+
+    Result measure(const Benchmark &benchmark, std::size_t iterations, Counters &counters)
+    {
+        counters.start();
+        auto startTime{std::chrono::steady_clock::now()};
+
+        benchmark.run(iterations);
+
+        std::chrono::duration<double, std::nano> elapsed{std::chrono::steady_clock::now() - startTime};
+        Counters::Values counts{counters.stop()};
+
+        Result result{elapsed.count() / iterations, {}};
+        for (int n{0}; n < Counters::COUNT; n++)
+            result.counts[n] = counts[n] / iterations;
+
+        return result;
+    }
+
+    // Fastest of REPEATS runs of about the given time each
+    Result benchmark(const Benchmark &benchmark, std::chrono::milliseconds time, Counters &counters)
+    {
+        const double target{std::chrono::duration<double, std::nano>(time).count()};
+
+        // Grow the iteration count until a run takes a noticeable share of the target
+        std::size_t iterations{16};
+        double nanoseconds{measure(benchmark, iterations, counters).nanoseconds};
+        while (nanoseconds * iterations < target / 10)
+        {
+            iterations *= 4;
+            nanoseconds = measure(benchmark, iterations, counters).nanoseconds;
+        }
+        iterations = std::max<std::size_t>(1, target / nanoseconds);
+
+        Result best{std::numeric_limits<double>::infinity(), {}};
+        for (int n{0}; n < REPEATS; n++)
+        {
+            Result result{measure(benchmark, iterations, counters)};
+            if (result.nanoseconds < best.nanoseconds)
+                best = result;
+        }
+
+        return best;
+    }
+
+    std::vector<Benchmark> benchmarks(int size)
+    {
+        // Boards shared by the benchmarks, and a random walk that returns to where it started
+        auto pool{std::make_shared<std::vector<Puzzle>>()};
+        for (std::size_t n{0}; n < POOL_SIZE; n++)
+            pool->emplace_back(size);
+
+        auto walk{std::make_shared<std::vector<Puzzle::Move>>()};
+        {
+            std::mt19937 rng{1};
+            Puzzle puzzle{pool->front()};
+            for (std::size_t n{0}; n < 4096; n++)
+            {
+                std::vector<Puzzle::Move> moves{puzzle.validMoves()};
+                Puzzle::Move move{moves[rng() % moves.size()]};
+                puzzle.move(move);
+                walk->push_back(move);
+            }
+            for (std::size_t n{walk->size()}; n > 0; n--)
+                walk->push_back(Puzzle::inverse((*walk)[n - 1]));
+        }
+
+        auto copies{std::make_shared<std::vector<Puzzle>>(*pool)};
+
+        std::vector<Benchmark> list{
+            {"move", [pool, walk](std::size_t iterations)
+             {
+                 Puzzle &puzzle{pool->front()};
+                 for (std::size_t n{0}, step{0}; n < iterations; n++)
+                 {
+                     keep(puzzle.move((*walk)[step]));
+                     step = step + 1 < walk->size() ? step + 1 : 0;
+                 }
+             }},
+            {"copy", [pool](std::size_t iterations)
+             {
+                 for (std::size_t n{0}; n < iterations; n++)
+                 {
+                     Puzzle copy{(*pool)[n % POOL_SIZE]};
+                     keep(copy.getBlank());
+                 }
+             }},
+            {"validMoves", [pool](std::size_t iterations)
+             {
+                 for (std::size_t n{0}; n < iterations; n++)
+                     keep((*pool)[n % POOL_SIZE].validMoves().size());
+             }},
+            {"operator==", [pool, copies](std::size_t iterations)
+             {
+                 // Equal boards, so every tile is compared
+                 for (std::size_t n{0}; n < iterations; n++)
+                     keep((*pool)[n % POOL_SIZE] == (*copies)[n % POOL_SIZE]);
+             }},
+            {"inversionCount", [pool](std::size_t iterations)
+             {
+                 for (std::size_t n{0}; n < iterations; n++)
+                     keep((*pool)[n % POOL_SIZE].inversionCount());
+             }},
+        };
+
+        std::vector<std::pair<std::string, std::shared_ptr<const Puzzle::Heuristic>>> heuristics{
+            {"manhattan", std::make_shared<Heuristic::ManhattanDistanceHeuristic>()},
+            {"linear-conflict", std::make_shared<Heuristic::LinearConflictHeuristic>()},
+            {"linear-conflict-table", std::make_shared<Heuristic::LinearConflictTableHeuristic>()},
+            {"misplaced", std::make_shared<Heuristic::MisplacedTilesHeuristic>()},
+            {"reflection-dual", std::make_shared<Heuristic::ReflectionDualHeuristic>(std::make_shared<Heuristic::LinearConflictTableHeuristic>())},
+        };
+
+        for (const auto &[name, heuristic] : heuristics)
+        {
+            list.push_back({"h " + name, [pool, heuristic = heuristic](std::size_t iterations)
+                            {
+                                for (std::size_t n{0}; n < iterations; n++)
+                                    keep((*heuristic)((*pool)[n % POOL_SIZE]));
+                            }});
+        }
+
+        return list;
+    }
+
+    void printCount(double count)
+    {
+        if (std::isnan(count))
+            std::cout << std::setw(12) << "-";
+        else
+            std::cout << std::setw(12) << count;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int size{15};
+    std::chrono::milliseconds time{200};
+    std::string filter{};
+
+    try
+    {
+        for (int n{1}; n < argc; n++)
+        {
+            std::string arg{argv[n]};
+            bool hasValue{n + 1 < argc};
+
+            if (arg == "--size" && hasValue)
+                size = std::stoi(argv[++n]);
+            else if (arg == "--time" && hasValue)
+                time = std::chrono::milliseconds{std::stoul(argv[++n])};
+            else if (arg == "--filter" && hasValue)
+                filter = argv[++n];
+            else
+            {
+                std::cerr << USAGE;
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << USAGE;
+        return 1;
+    }
+
+    int dimension{static_cast<int>(std::lround(std::sqrt(size + 1)))};
+    if (size < 3 || dimension * dimension != size + 1)
+    {
+        std::cerr << USAGE;
+        return 1;
+    }
+
+    Counters counters{};
+    if (!counters.available())
+        std::cout << "# hardware counters unavailable (" << counters.getError() << "), reporting time only\n";
+    else if (!counters.getError().empty())
+        std::cout << "# some hardware counters unavailable (" << counters.getError() << ")\n";
+
+    std::cout << "# " << dimension << 'x' << dimension << " board, per operation\n";
+    std::cout << std::left << std::setw(24) << "benchmark" << std::right << std::setw(12) << "ns";
+    for (const char *name : Counters::NAMES)
+        std::cout << std::setw(12) << name;
+    std::cout << '\n';
+
+    std::cout << std::fixed << std::setprecision(2);
+
+    for (const Benchmark &entry : benchmarks(size))
+    {
+        if (entry.name.find(filter) == std::string::npos)
+            continue;
+
+        Result result{benchmark(entry, time, counters)};
+
+        std::cout << std::left << std::setw(24) << entry.name << std::right << std::setw(12) << result.nanoseconds;
+        for (double count : result.counts)
+            printCount(count);
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+// Compares solver engines on the same puzzles.
+//
+// Puzzles are read from standard input, one per line as the tiles in row-major order with 0
+// for the blank. Every puzzle is solved by each engine in turn, printing the solution length
+// followed by the time and node count (expansions) of every engine, and totals once all are done.
+// Every engine is optimal, a puzzle one of them solves in another length than serial IDA* is
+// flagged with the lengths found and makes the exit status 1.
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "automaton.h"
+#include "heuristic.h"
+#include "puzzle.h"
+
+namespace
+{
+    const char USAGE[] = "Usage: fifteen-bench [options] < puzzles\n"
+                         "  --heuristic NAME   linear-conflict, linear-conflict-table, manhattan or misplaced\n"
+                         "                     (default linear-conflict-table)\n"
+                         "  --cr               Use the controlled threshold policy\n"
+                         "  --threads N        Threads of the parallel window engine (default one per core)\n"
+                         "  --memory MB        Memory of the A* engine before it falls back to IDA* (default 256)\n";
+
+    struct Engine
+    {
+        const char *name;
+        Puzzle::Engine engine;
+
+        double seconds;
+        unsigned long long nodes;
+        std::size_t peakMemory;
+        // Puzzles it left to serial IDA*
+        std::size_t fallbacks;
+        // Puzzles it solved in another length than the first engine
+        std::size_t mismatches;
+    };
+}
+
+int main(int argc, char **argv)
+{
+    std::shared_ptr<Puzzle::Heuristic> heuristic{std::make_shared<Heuristic::LinearConflictTableHeuristic>()};
+    Puzzle::Options options{};
+
+    for (int n{1}; n < argc; n++)
+    {
+        std::string arg{argv[n]};
+        std::string value{n + 1 < argc ? argv[n + 1] : ""};
+
+        if (arg == "--heuristic" && value == "linear-conflict")
+            heuristic = std::make_shared<Heuristic::LinearConflictHeuristic>();
+        else if (arg == "--heuristic" && value == "linear-conflict-table")
+            heuristic = std::make_shared<Heuristic::LinearConflictTableHeuristic>();
+        else if (arg == "--heuristic" && value == "manhattan")
+            heuristic = std::make_shared<Heuristic::ManhattanDistanceHeuristic>();
+        else if (arg == "--heuristic" && value == "misplaced")
+            heuristic = std::make_shared<Heuristic::MisplacedTilesHeuristic>();
+        else if (arg == "--cr")
+        {
+            options.threshold = Puzzle::Threshold::CONTROLLED;
+            continue;
+        }
+        else if (arg == "--threads" && !value.empty() && value.find_first_not_of("0123456789") == std::string::npos)
+            options.threads = std::stoul(value);
+        else if (arg == "--memory" && !value.empty() && value.find_first_not_of("0123456789") == std::string::npos)
+            options.memoryLimit = std::stoul(value) << 20;
+        else
+        {
+            std::cerr << USAGE;
+            return 1;
+        }
+        n++;
+    }
+
+    // Build the move automaton up front rather than timing it with the first puzzle
+    Search::MoveAutomaton::get(options.pruneLength);
+
+    std::vector<Engine> engines{
+        {"ida*", Puzzle::Engine::IDA_STAR, 0, 0, 0, 0, 0},
+        {"fringe", Puzzle::Engine::FRINGE, 0, 0, 0, 0, 0},
+        {"a*", Puzzle::Engine::A_STAR, 0, 0, 0, 0, 0},
+        {"window", Puzzle::Engine::PARALLEL_WINDOW, 0, 0, 0, 0, 0},
+    };
+
+    std::cout << "#\tlength";
+    for (const Engine &engine : engines)
+        std::cout << '\t' << engine.name << "\tnodes";
+    std::cout << '\n';
+
+    Puzzle puzzle{15};
+    std::string line{};
+    std::size_t count{0};
+
+    while (std::getline(std::cin, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        count++;
+        std::cout << count << '\t';
+
+        if (!puzzle.parseTiles(line) || !puzzle.isSolvable())
+        {
+            std::cout << "skipped\n";
+            continue;
+        }
+
+        // Of each engine, the first one's is the reference
+        std::vector<std::size_t> lengths{};
+        std::ostringstream columns{};
+        columns << std::fixed << std::setprecision(4);
+
+        for (Engine &engine : engines)
+        {
+            Puzzle::Options engineOptions{options};
+            engineOptions.engine = engine.engine;
+
+            std::atomic<bool> running{true};
+            Puzzle::Stats stats{};
+
+            auto startTime{std::chrono::steady_clock::now()};
+            lengths.push_back(puzzle.solveMoves(*heuristic, running, engineOptions, stats).size());
+            std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - startTime};
+
+            engine.seconds += elapsed.count();
+            engine.nodes += stats.nodes;
+            engine.peakMemory = std::max(engine.peakMemory, stats.peakMemory);
+            engine.fallbacks += stats.engine != engine.engine;
+            engine.mismatches += lengths.back() != lengths.front();
+
+            columns << '\t' << elapsed.count() << '\t' << stats.nodes;
+        }
+
+        std::cout << lengths.front() << columns.str();
+        for (std::size_t n{1}; n < engines.size(); n++)
+        {
+            if (lengths[n] != lengths.front())
+                std::cout << "\tmismatch " << engines[n].name << ' ' << lengths[n];
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "# total\t";
+    std::cout << std::fixed << std::setprecision(4);
+    for (const Engine &engine : engines)
+        std::cout << '\t' << engine.seconds << '\t' << engine.nodes;
+    std::cout << '\n';
+
+    for (const Engine &engine : engines)
+    {
+        std::cout << "# " << engine.name << ": " << engines[0].seconds / engine.seconds << "x the speed of " << engines[0].name;
+        // Only engines that keep states report their memory
+        if (engine.peakMemory > 0)
+            std::cout << ", peak memory " << std::setprecision(1) << engine.peakMemory / 1048576.0 << " MiB" << std::setprecision(4);
+        if (engine.fallbacks > 0)
+            std::cout << ", " << engine.fallbacks << " puzzles solved by " << engines[0].name << " instead";
+        if (engine.mismatches > 0)
+            std::cout << ", " << engine.mismatches << " puzzles solved in another length than " << engines[0].name;
+        std::cout << '\n';
+    }
+
+    bool agreed{std::all_of(engines.begin(), engines.end(), [](const Engine &engine)
+                            { return engine.mismatches == 0; })};
+    return agreed ? 0 : 1;
+}
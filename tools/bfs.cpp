@@ -0,0 +1,139 @@
+// Breadth-first search over a whole sliding-tile state space, or the pattern of some of its
+// tiles, keeping the layers on disk (see frontier.h). Prints the number of states at every
+// distance from the goal, the radius of the space and the hardest positions.
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frontier.h"
+
+namespace
+{
+    const char USAGE[] = "Usage: fifteen-bfs [options]\n"
+                         "  --rows N       Board rows (default 3)\n"
+                         "  --cols N       Board columns (default 3)\n"
+                         "  --tiles LIST   Comma separated tiles to tell apart, others are indistinguishable (default all)\n"
+                         "  --dir PATH     Directory for layer and run files (default .)\n"
+                         "  --memory MB    Memory budget for successor and file buffers (default 256)\n"
+                         "  --threads N    Expansion threads (default all cores)\n"
+                         "  --hardest N    Number of hardest positions to print (default 10)\n"
+                         "  --keep         Keep layer files after finishing\n";
+
+    std::vector<int> parseTiles(const std::string &list)
+    {
+        std::vector<int> tiles{};
+
+        std::istringstream stream{list};
+        std::string item;
+        while (std::getline(stream, item, ','))
+            tiles.push_back(std::stoi(item));
+
+        return tiles;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int rows{3}, cols{3};
+    std::vector<int> tiles{};
+    std::string dir{"."};
+    std::size_t memory{256};
+    std::size_t threads{std::max(1u, std::thread::hardware_concurrency())};
+    std::size_t hardest{10};
+    bool keep{false};
+
+    try
+    {
+        for (int n{1}; n < argc; n++)
+        {
+            std::string arg{argv[n]};
+            bool hasValue{n + 1 < argc};
+
+            if (arg == "--rows" && hasValue)
+                rows = std::stoi(argv[++n]);
+            else if (arg == "--cols" && hasValue)
+                cols = std::stoi(argv[++n]);
+            else if (arg == "--tiles" && hasValue)
+                tiles = parseTiles(argv[++n]);
+            else if (arg == "--dir" && hasValue)
+                dir = argv[++n];
+            else if (arg == "--memory" && hasValue)
+                memory = std::stoul(argv[++n]);
+            else if (arg == "--threads" && hasValue)
+                threads = std::max<std::size_t>(1, std::stoul(argv[++n]));
+            else if (arg == "--hardest" && hasValue)
+                hardest = std::stoul(argv[++n]);
+            else if (arg == "--keep")
+                keep = true;
+            else
+            {
+                std::cerr << USAGE;
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << USAGE;
+        return 1;
+    }
+
+    int cells{rows * cols};
+    if (rows < 1 || cols < 1 || cells < 2 || cells > 20)
+    {
+        std::cerr << "Board must have between 2 and 20 cells\n";
+        return 1;
+    }
+
+    if (tiles.empty())
+    {
+        for (int n{1}; n < cells; n++)
+            tiles.push_back(n);
+    }
+    for (int tile : tiles)
+    {
+        if (tile < 1 || tile >= cells || std::count(tiles.begin(), tiles.end(), tile) > 1)
+        {
+            std::cerr << "Tiles must be distinct and between 1 and " << cells - 1 << '\n';
+            return 1;
+        }
+    }
+
+    Frontier::Space space{rows, cols, tiles};
+    Frontier::BreadthFirstSearch search{space, dir, threads, memory << 20};
+
+    try
+    {
+        std::cout << "# " << rows << 'x' << cols << ", " << tiles.size() << " tiles, " << space.size() << " ranks\n";
+        std::cout << "0\t1" << std::endl;
+
+        std::vector<std::uint64_t> counts{search.run(keep, [](unsigned int depth, std::uint64_t count)
+                                                      { std::cout << depth << '\t' << count << std::endl; })};
+
+        std::uint64_t total{0};
+        for (std::uint64_t count : counts)
+            total += count;
+
+        unsigned int depth = counts.size() - 1;
+        std::cout << "# " << total << " states, radius " << depth << '\n';
+
+        for (std::uint64_t rank : search.hardest(depth, hardest))
+            std::cout << '\n' << space.format(rank);
+
+        if (!keep)
+            search.cleanup(depth);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
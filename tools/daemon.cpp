@@ -0,0 +1,859 @@
+// Serves solve requests over a line-delimited JSON protocol. The heuristic tables, the move
+// automaton and a pool of workers are set up once and stay warm between requests.
+//
+//   fifteen-daemon [--threads N] [--socket PATH]
+//
+// Requests are read from standard input, or from every client of a Unix domain socket, one
+// JSON object per line. Responses are written back one per line in the order requests finish,
+// so a client may send many requests without waiting and match the responses by id.
+//
+//   {"id": 1, "op": "solve", "tiles": [1, 2, 3, 4, 5, 6, 7, 0, 8]}
+//       also takes "heuristic" (linear-conflict-table, the default, linear-conflict, manhattan or
+//       misplaced), "engine" (ida*, fringe, a* or window), "weight" and "deadline" in milliseconds
+//       from receipt
+//   -> {"id":1,"status":"solved","moves":"R","length":1,"engine":"ida*","nodes":1,"ms":0.052}
+//       status is solved, unsolvable, deadline, cancelled, failed (maximum depth) or error;
+//       moves are those of the blank, U D L R; engine is the one that found them, ida* when the
+//       one asked for cannot solve the puzzle
+//   {"id": 2, "op": "cancel", "target": 1}
+//   -> {"id":2,"status":"ok","found":true}, then request 1 answers cancelled
+//   {"id": 3, "op": "stats"}
+//   -> {"id":3,"status":"ok","received":...,"completed":...,"queued":...,"active":...,
+//       "uptime":...,"throughput":...,"statuses":{...},"latency":{"p50":...,"p90":...,"p99":...,"max":...}}
+//
+// Latencies are in milliseconds from receipt to response, over the last LATENCY_WINDOW
+// requests; throughput is in requests completed per second of uptime. Only flat objects are
+// understood, with strings, numbers, booleans, null and arrays of numbers as values.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "automaton.h"
+#include "heuristic.h"
+#include "puzzle.h"
+
+namespace
+{
+    const char USAGE[] = "Usage: fifteen-daemon [--threads N] [--socket PATH]\n";
+
+    // Indexed by Puzzle::Engine
+    const char *const ENGINE_NAMES[]{"ida*", "fringe", "a*", "window"};
+
+    // Completed requests whose latencies the percentiles are taken over
+    const std::size_t LATENCY_WINDOW{10000};
+    // Longest request line a socket client may send before it is dropped
+    const std::size_t MAX_LINE{1 << 20};
+
+    struct Value
+    {
+        enum Type
+        {
+            NONE, // Key not present
+            NULL_VALUE,
+            BOOLEAN,
+            NUMBER,
+            STRING,
+            ARRAY
+        };
+
+        Type type{Type::NONE};
+        // Contents of a string or the literal of a number
+        std::string text{};
+        double number{};
+        std::vector<double> items{};
+    };
+
+    using Object = std::map<std::string, Value>;
+
+    class Parser
+    {
+    private:
+        const std::string &text;
+        std::size_t pos{0};
+
+        void skipSpace()
+        {
+            while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+                pos++;
+        }
+
+        bool consume(char c)
+        {
+            skipSpace();
+            if (pos >= text.size() || text[pos] != c)
+                return false;
+
+            pos++;
+            return true;
+        }
+
+        bool parseString(std::string &out)
+        {
+            if (!consume('"'))
+                return false;
+
+            out.clear();
+            while (pos < text.size())
+            {
+                char c{text[pos++]};
+                if (c == '"')
+                    return true;
+                if (c != '\\')
+                {
+                    out += c;
+                    continue;
+                }
+
+                if (pos >= text.size())
+                    return false;
+
+                switch (char escaped{text[pos++]})
+                {
+                case '"':
+                case '\\':
+                case '/':
+                    out += escaped;
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                {
+                    if (pos + 4 > text.size())
+                        return false;
+
+                    std::string digits{text, pos, 4};
+                    char *end{};
+                    unsigned long code{std::strtoul(digits.c_str(), &end, 16)};
+                    if (end != digits.c_str() + 4)
+                        return false;
+
+                    // Strings are only ids and names, anything beyond ASCII is replaced
+                    out += code < 0x80 ? static_cast<char>(code) : '?';
+                    pos += 4;
+                    break;
+                }
+                default:
+                    return false;
+                }
+            }
+
+            return false;
+        }
+
+        bool parseNumber(double &number, std::string &literal)
+        {
+            skipSpace();
+
+            std::size_t end{pos};
+            while (end < text.size() && (std::isdigit(static_cast<unsigned char>(text[end])) || std::string{"+-.eE"}.find(text[end]) != std::string::npos))
+                end++;
+
+            literal.assign(text, pos, end - pos);
+            if (literal.empty() || !(literal[0] == '-' || std::isdigit(static_cast<unsigned char>(literal[0]))))
+                return false;
+
+            char *parsed{};
+            number = std::strtod(literal.c_str(), &parsed);
+            if (parsed != literal.c_str() + literal.size())
+                return false;
+
+            pos = end;
+            return true;
+        }
+
+        bool parseValue(Value &value)
+        {
+            skipSpace();
+            if (pos >= text.size())
+                return false;
+
+            if (text[pos] == '"')
+            {
+                value.type = Value::STRING;
+                return parseString(value.text);
+            }
+
+            if (text[pos] == '[')
+            {
+                pos++;
+                value.type = Value::ARRAY;
+                if (consume(']'))
+                    return true;
+
+                do
+                {
+                    double item{};
+                    std::string literal{};
+                    if (!parseNumber(item, literal))
+                        return false;
+                    value.items.push_back(item);
+                } while (consume(','));
+
+                return consume(']');
+            }
+
+            for (auto [literal, type, number] : {std::make_tuple("true", Value::BOOLEAN, 1.0),
+                                                 std::make_tuple("false", Value::BOOLEAN, 0.0),
+                                                 std::make_tuple("null", Value::NULL_VALUE, 0.0)})
+            {
+                std::string word{literal};
+                if (text.compare(pos, word.size(), word) == 0)
+                {
+                    pos += word.size();
+                    value.type = type;
+                    value.number = number;
+                    return true;
+                }
+            }
+
+            value.type = Value::NUMBER;
+            return parseNumber(value.number, value.text);
+        }
+
+    public:
+        Parser(const std::string &text)
+            : text(text)
+        {
+        }
+
+        bool parse(Object &object)
+        {
+            if (!consume('{'))
+                return false;
+
+            if (!consume('}'))
+            {
+                do
+                {
+                    std::string key{};
+                    Value value{};
+                    if (!parseString(key) || !consume(':') || !parseValue(value))
+                        return false;
+
+                    object[key] = std::move(value);
+                } while (consume(','));
+
+                if (!consume('}'))
+                    return false;
+            }
+
+            skipSpace();
+            return pos == text.size();
+        }
+    };
+
+    std::string quote(const std::string &text)
+    {
+        std::string out{"\""};
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+                out += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            }
+            else
+            {
+                out += c;
+            }
+        }
+
+        return out + '"';
+    }
+
+    // JSON of an id as it is echoed back, null unless a string or number
+    std::string serialize(const Value &id)
+    {
+        if (id.type == Value::STRING)
+            return quote(id.text);
+        if (id.type == Value::NUMBER)
+            return id.text;
+        return "null";
+    }
+
+    // Whether a number is a whole one within [min, max], so that it converts without loss
+    bool isInteger(double number, double min, double max)
+    {
+        return std::floor(number) == number && number >= min && number <= max;
+    }
+
+    // A client the requests come from and the responses go back to, standard input and output
+    // when fd is -1. Responses are written whole by one thread at a time.
+    class Connection
+    {
+    private:
+        const int fd;
+        std::mutex mutex{};
+        bool open{true};
+
+        // Received past the last complete line
+        std::string buffer{};
+
+    public:
+        Connection(int fd)
+            : fd(fd)
+        {
+        }
+
+        Connection(const Connection &) = delete;
+        Connection &operator=(const Connection &) = delete;
+
+        ~Connection()
+        {
+#ifndef _WIN32
+            if (fd >= 0)
+                ::close(fd);
+#endif
+        }
+
+        // Next non-empty line, false once the client is gone
+        bool receive(std::string &line)
+        {
+            if (fd < 0)
+            {
+                while (std::getline(std::cin, line))
+                {
+                    if (!line.empty())
+                        return true;
+                }
+                return false;
+            }
+
+#ifndef _WIN32
+            while (true)
+            {
+                std::size_t end{};
+                while ((end = buffer.find('\n')) != std::string::npos)
+                {
+                    line.assign(buffer, 0, end);
+                    buffer.erase(0, end + 1);
+
+                    if (!line.empty() && line.back() == '\r')
+                        line.pop_back();
+                    if (!line.empty())
+                        return true;
+                }
+
+                if (buffer.size() > MAX_LINE)
+                    return false;
+
+                char chunk[4096];
+                ssize_t count{::read(fd, chunk, sizeof(chunk))};
+                if (count < 0 && errno == EINTR)
+                    continue;
+                if (count <= 0)
+                    return false;
+
+                buffer.append(chunk, count);
+            }
+#else
+            return false;
+#endif
+        }
+
+        void send(const std::string &line)
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (!open)
+                return;
+
+            if (fd < 0)
+            {
+                std::cout << line << std::endl;
+                return;
+            }
+
+#ifndef _WIN32
+            std::string data{line + '\n'};
+            for (std::size_t sent{0}; sent < data.size();)
+            {
+                ssize_t count{::write(fd, data.data() + sent, data.size() - sent)};
+                if (count < 0 && errno == EINTR)
+                    continue;
+                if (count <= 0)
+                {
+                    open = false;
+                    return;
+                }
+                sent += count;
+            }
+#endif
+        }
+
+        void close()
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            open = false;
+        }
+    };
+
+    struct Job
+    {
+        const std::shared_ptr<Connection> connection;
+        // As sent, to be echoed back
+        const std::string id;
+        const Puzzle puzzle;
+
+        std::shared_ptr<const Puzzle::Heuristic> heuristic{};
+        Puzzle::Options options{};
+        std::chrono::steady_clock::time_point received{std::chrono::steady_clock::now()};
+        // Cleared to cancel
+        std::atomic<bool> running{true};
+
+        Job(std::shared_ptr<Connection> connection, const std::string &id, const Puzzle &puzzle)
+            : connection(connection), id(id), puzzle(puzzle)
+        {
+        }
+    };
+
+    class Daemon
+    {
+    private:
+        // Shared by all workers, every search takes an instance of its own of those keeping state
+        std::map<std::string, std::shared_ptr<const Puzzle::Heuristic>> heuristics{};
+        const std::chrono::steady_clock::time_point started{std::chrono::steady_clock::now()};
+
+        // Everything below is guarded by mutex
+        std::mutex mutex{};
+        std::condition_variable wake{};
+        std::condition_variable idle{};
+        std::deque<std::shared_ptr<Job>> queue{};
+        // Jobs queued or being solved, by connection and id, to be found by cancel requests
+        std::map<std::pair<const Connection *, std::string>, std::shared_ptr<Job>> pending{};
+        unsigned int active{0};
+        bool stopping{false};
+
+        unsigned long long received{0};
+        unsigned long long completed{0};
+        std::map<std::string, unsigned long long> statuses{};
+        // Ring of the latest latencies in milliseconds
+        std::vector<double> latencies{};
+        std::size_t nextLatency{0};
+
+        std::vector<std::thread> workers{};
+
+        void work()
+        {
+            while (true)
+            {
+                std::shared_ptr<Job> job{};
+                {
+                    std::unique_lock<std::mutex> lock{mutex};
+                    wake.wait(lock, [this]()
+                              { return stopping || !queue.empty(); });
+                    if (queue.empty())
+                        return;
+
+                    job = queue.front();
+                    queue.pop_front();
+                    active++;
+                }
+
+                solve(*job);
+
+                std::lock_guard<std::mutex> lock{mutex};
+                active--;
+                if (queue.empty() && active == 0)
+                    idle.notify_all();
+            }
+        }
+
+        void solve(Job &job)
+        {
+            Puzzle::Stats stats{};
+            std::string status{};
+            std::string fields{};
+
+            try
+            {
+                if (!job.running.load())
+                    throw Puzzle::CancelledException();
+                if (std::chrono::steady_clock::now() >= job.options.deadline)
+                    throw Puzzle::DeadlineException();
+
+                std::vector<Puzzle::Move> moves{job.puzzle.solveMoves(*job.heuristic, job.running, job.options, stats)};
+
+                std::string names{};
+                for (Puzzle::Move move : moves)
+                    names += Puzzle::MOVE_NAMES[move];
+
+                status = "solved";
+                fields = ",\"moves\":" + quote(names) + ",\"length\":" + std::to_string(moves.size()) + ",\"engine\":" + quote(ENGINE_NAMES[stats.engine]);
+            }
+            catch (Puzzle::UnsolvableException &)
+            {
+                status = "unsolvable";
+            }
+            catch (Puzzle::DeadlineException &)
+            {
+                status = "deadline";
+            }
+            catch (Puzzle::CancelledException &)
+            {
+                status = "cancelled";
+            }
+            catch (Puzzle::MaxThresholdException &)
+            {
+                status = "failed";
+            }
+            // E.g. out of memory or threads, fails the request rather than the daemon
+            catch (const std::exception &e)
+            {
+                status = "error";
+                fields = ",\"error\":" + quote(e.what());
+            }
+
+            fields += ",\"nodes\":" + std::to_string(stats.nodes);
+            finish(job, status, fields);
+        }
+
+        void finish(Job &job, const std::string &status, const std::string &fields)
+        {
+            double latency{std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job.received).count()};
+
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                pending.erase({job.connection.get(), job.id});
+
+                completed++;
+                statuses[status]++;
+
+                if (latencies.size() < LATENCY_WINDOW)
+                    latencies.push_back(latency);
+                else
+                    latencies[nextLatency] = latency;
+                nextLatency = (nextLatency + 1) % LATENCY_WINDOW;
+            }
+
+            std::ostringstream response{};
+            response << std::fixed << std::setprecision(3);
+            response << "{\"id\":" << job.id << ",\"status\":\"" << status << '"' << fields << ",\"ms\":" << latency << '}';
+            job.connection->send(response.str());
+        }
+
+        void submit(const std::shared_ptr<Connection> &connection, const std::string &id, Object &request)
+        {
+            auto error{[&](const char *message)
+                       { connection->send("{\"id\":" + id + ",\"status\":\"error\",\"error\":" + quote(message) + '}'); }};
+
+            std::vector<int> tiles{};
+            for (double tile : request["tiles"].items)
+            {
+                if (!isInteger(tile, 0, std::numeric_limits<int>::max()))
+                    return error("tiles must be a square permutation");
+                tiles.push_back(static_cast<int>(tile));
+            }
+
+            Puzzle puzzle{8};
+            if (request["tiles"].type != Value::ARRAY || !puzzle.setTiles(tiles))
+                return error("tiles must be a square permutation");
+
+            auto job{std::make_shared<Job>(connection, id, puzzle)};
+
+            const Value &heuristic{request["heuristic"]};
+            auto found{heuristics.find(heuristic.type == Value::STRING ? heuristic.text : "linear-conflict-table")};
+            if (found == heuristics.end())
+                return error("unknown heuristic");
+            job->heuristic = found->second;
+
+            const Value &engine{request["engine"]};
+            if (engine.type == Value::STRING && engine.text == "fringe")
+                job->options.engine = Puzzle::Engine::FRINGE;
+            else if (engine.type == Value::STRING && engine.text == "a*")
+                job->options.engine = Puzzle::Engine::A_STAR;
+            else if (engine.type == Value::STRING && engine.text == "window")
+                job->options.engine = Puzzle::Engine::PARALLEL_WINDOW;
+            else if (engine.type != Value::NONE && !(engine.type == Value::STRING && engine.text == "ida*"))
+                return error("unknown engine");
+
+            const Value &weight{request["weight"]};
+            if (weight.type == Value::NUMBER && isInteger(weight.number, 1, std::numeric_limits<unsigned int>::max()))
+                job->options.weight = static_cast<unsigned int>(weight.number);
+            else if (weight.type != Value::NONE)
+                return error("weight must be a whole number of at least 1");
+
+            const Value &deadline{request["deadline"]};
+            if (deadline.type == Value::NUMBER && deadline.number >= 0)
+                job->options.deadline = job->received + std::chrono::microseconds{static_cast<long long>(deadline.number * 1000)};
+            else if (deadline.type != Value::NONE)
+                return error("deadline must be a number of milliseconds");
+
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                // Requests without an id cannot be cancelled and need not be told apart
+                if (id != "null" && !pending.emplace(std::make_pair(connection.get(), id), job).second)
+                    return error("a request with this id is still pending");
+
+                received++;
+                queue.push_back(job);
+            }
+            wake.notify_one();
+        }
+
+        void cancel(const std::shared_ptr<Connection> &connection, const std::string &id, const Value &target)
+        {
+            bool found{false};
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                auto job{pending.find({connection.get(), serialize(target)})};
+                if (job != pending.end())
+                {
+                    job->second->running = false;
+                    found = true;
+                }
+            }
+
+            connection->send("{\"id\":" + id + ",\"status\":\"ok\",\"found\":" + (found ? "true" : "false") + '}');
+        }
+
+        void report(const std::shared_ptr<Connection> &connection, const std::string &id)
+        {
+            std::ostringstream response{};
+            response << std::fixed << std::setprecision(3);
+
+            std::lock_guard<std::mutex> lock{mutex};
+
+            double uptime{std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count()};
+            response << "{\"id\":" << id << ",\"status\":\"ok\",\"received\":" << received << ",\"completed\":" << completed
+                     << ",\"queued\":" << queue.size() << ",\"active\":" << active << ",\"uptime\":" << uptime
+                     << ",\"throughput\":" << completed / uptime << ",\"statuses\":{";
+
+            for (auto it{statuses.begin()}; it != statuses.end(); it++)
+                response << (it == statuses.begin() ? "" : ",") << quote(it->first) << ':' << it->second;
+
+            // Nearest rank percentiles
+            std::vector<double> sorted{latencies};
+            std::sort(sorted.begin(), sorted.end());
+            auto percentile{[&sorted](double p)
+                            { return sorted.empty() ? 0.0 : sorted[std::max(std::ceil(p * sorted.size()), 1.0) - 1]; }};
+
+            response << "},\"latency\":{\"p50\":" << percentile(0.5) << ",\"p90\":" << percentile(0.9)
+                     << ",\"p99\":" << percentile(0.99) << ",\"max\":" << percentile(1) << "}}";
+
+            connection->send(response.str());
+        }
+
+    public:
+        Daemon(unsigned int threads)
+        {
+            heuristics["linear-conflict"] = std::make_shared<Heuristic::LinearConflictHeuristic>();
+            heuristics["linear-conflict-table"] = std::make_shared<Heuristic::LinearConflictTableHeuristic>();
+            heuristics["manhattan"] = std::make_shared<Heuristic::ManhattanDistanceHeuristic>();
+            heuristics["misplaced"] = std::make_shared<Heuristic::MisplacedTilesHeuristic>();
+
+            // Build everything built on first use now, rather than in the first request of each kind
+            Search::MoveAutomaton::get(Puzzle::Options{}.pruneLength);
+            for (int dimension{3}; dimension <= Heuristic::LinearConflictTableHeuristic::TABLE_MAX_DIMENSION; dimension++)
+            {
+                Puzzle puzzle{dimension * dimension - 1};
+                for (const auto &heuristic : heuristics)
+                    (*heuristic.second)(puzzle);
+            }
+
+            for (unsigned int n{0}; n < threads; n++)
+                workers.emplace_back(&Daemon::work, this);
+        }
+
+        Daemon(const Daemon &) = delete;
+        Daemon &operator=(const Daemon &) = delete;
+
+        ~Daemon()
+        {
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                stopping = true;
+                for (auto &job : pending)
+                    job.second->running = false;
+            }
+            wake.notify_all();
+
+            for (std::thread &worker : workers)
+                worker.join();
+        }
+
+        void handle(const std::shared_ptr<Connection> &connection, const std::string &line)
+        {
+            Object request{};
+            if (!Parser{line}.parse(request))
+            {
+                connection->send("{\"id\":null,\"status\":\"error\",\"error\":\"malformed request\"}");
+                return;
+            }
+
+            std::string id{serialize(request["id"])};
+            const Value &op{request["op"]};
+
+            if (op.text == "solve")
+                submit(connection, id, request);
+            else if (op.text == "cancel")
+                cancel(connection, id, request["target"]);
+            else if (op.text == "stats")
+                report(connection, id);
+            else
+                connection->send("{\"id\":" + id + ",\"status\":\"error\",\"error\":\"unknown op\"}");
+        }
+
+        // Cancels the requests of a client that went away, nobody is left to read their responses
+        void disconnect(Connection &connection)
+        {
+            connection.close();
+
+            std::lock_guard<std::mutex> lock{mutex};
+            for (auto &job : pending)
+            {
+                if (job.first.first == &connection)
+                    job.second->running = false;
+            }
+        }
+
+        // Waits until no request is queued or being solved
+        void drain()
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            idle.wait(lock, [this]()
+                      { return queue.empty() && active == 0; });
+        }
+    };
+
+#ifndef _WIN32
+    int serve(Daemon &daemon, const std::string &path)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            std::cerr << "Socket path too long: " << path << '\n';
+            return 1;
+        }
+        std::copy(path.begin(), path.end(), address.sun_path);
+
+        // A socket left behind by an earlier run would fail the bind, anything else is kept
+        struct stat info{};
+        if (::lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+            ::unlink(path.c_str());
+
+        int listener{::socket(AF_UNIX, SOCK_STREAM, 0)};
+        if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || ::listen(listener, SOMAXCONN) < 0)
+        {
+            std::perror(path.c_str());
+            return 1;
+        }
+
+        std::cerr << "Listening on " << path << std::endl;
+
+        while (true)
+        {
+            int fd{::accept(listener, nullptr, nullptr)};
+            if (fd < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+
+                std::perror("accept");
+                return 1;
+            }
+
+            std::thread{[&daemon, connection{std::make_shared<Connection>(fd)}]()
+                        {
+                            std::string line{};
+                            while (connection->receive(line))
+                                daemon.handle(connection, line);
+
+                            daemon.disconnect(*connection);
+                        }}
+                .detach();
+        }
+    }
+#endif
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int threads{std::max(std::thread::hardware_concurrency(), 1u)};
+    std::string socketPath{};
+
+    for (int n{1}; n < argc; n++)
+    {
+        std::string arg{argv[n]};
+
+        if (arg == "--threads" && n + 1 < argc)
+            threads = std::max<unsigned long>(1, std::stoul(argv[++n]));
+#ifndef _WIN32
+        else if (arg == "--socket" && n + 1 < argc)
+            socketPath = argv[++n];
+#endif
+        else
+        {
+            std::cerr << USAGE;
+            return 1;
+        }
+    }
+
+#ifndef _WIN32
+    // Clients that hang up are noticed by failed writes instead
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    Daemon daemon{threads};
+
+#ifndef _WIN32
+    if (!socketPath.empty())
+        return serve(daemon, socketPath);
+#endif
+
+    auto connection{std::make_shared<Connection>(-1)};
+    std::string line{};
+    while (connection->receive(line))
+        daemon.handle(connection, line);
+
+    // Answer everything already read before exiting
+    daemon.drain();
+    return 0;
+}
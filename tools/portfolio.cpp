@@ -0,0 +1,119 @@
+// Solves a batch of puzzles by racing a portfolio of solver configurations on each of them.
+//
+// Puzzles are read from standard input, one per line as the tiles in row-major order with 0
+// for the blank, e.g. a 3x3 puzzle is nine numbers. Each solved puzzle prints the solution
+// length, the winning configuration and the time taken; every batch ends with the win count
+// of each configuration and may prune the portfolio down to its best configurations.
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "portfolio.h"
+
+namespace
+{
+    const char USAGE[] = "Usage: fifteen-portfolio [options] < puzzles\n"
+                         "  --batch N      Puzzles per batch (default 100)\n"
+                         "  --keep N       Configurations kept after each batch (default all)\n";
+
+    void printWins(const Search::PortfolioSearch &portfolio)
+    {
+        const auto &configs{portfolio.getConfigs()};
+        const auto &wins{portfolio.getWins()};
+
+        for (std::size_t n{0}; n < configs.size(); n++)
+            std::cout << "#\t" << std::setw(28) << std::left << configs[n].name << wins[n] << '\n';
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t batch{100};
+    std::size_t keep{0};
+
+    try
+    {
+        for (int n{1}; n < argc; n++)
+        {
+            std::string arg{argv[n]};
+            bool hasValue{n + 1 < argc};
+
+            if (arg == "--batch" && hasValue)
+                batch = std::max<std::size_t>(1, std::stoul(argv[++n]));
+            else if (arg == "--keep" && hasValue)
+                keep = std::stoul(argv[++n]);
+            else
+            {
+                std::cerr << USAGE;
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << USAGE;
+        return 1;
+    }
+
+    Search::PortfolioSearch portfolio{};
+    std::atomic<bool> running{true};
+
+    Puzzle puzzle{15};
+    std::string line{};
+    std::size_t count{0};
+
+    while (std::getline(std::cin, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        count++;
+        std::cout << count << '\t';
+
+        if (!puzzle.parseTiles(line))
+        {
+            std::cout << "invalid\n";
+            continue;
+        }
+
+        try
+        {
+            Search::PortfolioSearch::Result result{portfolio.run(puzzle, running)};
+
+            std::cout << result.moves.size() << '\t' << portfolio.getConfigs()[result.winner].name << '\t'
+                      << std::fixed << std::setprecision(3) << result.elapsed.count() / 1000000000.0 << "s\t"
+                      << result.stats.nodes << '/' << result.totalNodes << " nodes\n";
+        }
+        catch (Puzzle::UnsolvableException &)
+        {
+            std::cout << "unsolvable\n";
+        }
+        catch (Puzzle::MaxThresholdException &)
+        {
+            std::cout << "failed\n";
+        }
+
+        if (count % batch == 0)
+        {
+            std::cout << "# wins after " << count << " puzzles\n";
+            printWins(portfolio);
+
+            if (keep > 0 && keep < portfolio.getConfigs().size())
+            {
+                portfolio.prune(keep);
+                std::cout << "# pruned to " << keep << " configurations\n";
+            }
+        }
+        std::cout.flush();
+    }
+
+    if (count % batch != 0)
+    {
+        std::cout << "# wins after " << count << " puzzles\n";
+        printWins(portfolio);
+    }
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+// Solves a single puzzle optimally in a solver session whose progress can be checkpointed, so
+// that a solve taking hours survives the process being stopped and started again.
+//
+// The puzzle is read from standard input as its tiles in row-major order with 0 for the blank,
+// unless the search goes on from a checkpoint given with --resume. With --checkpoint, progress
+// is written to the file every interval and when the process is interrupted (SIGINT or SIGTERM).
+// The solution is printed as the moves of the blank, U D L R, followed by its length, the node
+// count and the time spent searching over all runs.
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "heuristic.h"
+#include "session.h"
+
+namespace
+{
+    const char USAGE[] = "Usage: fifteen-solve [options] < puzzle\n"
+                         "  --heuristic NAME   linear-conflict-table, linear-conflict, manhattan or misplaced\n"
+                         "                     (default linear-conflict-table), the same one again to resume\n"
+                         "  --cr               Use the controlled threshold policy\n"
+                         "  --checkpoint FILE  Save the progress to FILE periodically and when interrupted\n"
+                         "  --interval S       Seconds between two checkpoints (default 60)\n"
+                         "  --resume FILE      Go on from a checkpoint instead of reading a puzzle\n";
+
+    // How often the session and the interrupt flag are looked at
+    const std::chrono::milliseconds POLL_INTERVAL{50};
+
+    volatile std::sig_atomic_t interrupted{0};
+
+    void interrupt(int)
+    {
+        interrupted = 1;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::shared_ptr<Puzzle::Heuristic> heuristic{std::make_shared<Heuristic::LinearConflictTableHeuristic>()};
+    Puzzle::Options options{};
+    std::string checkpoint{};
+    std::string resume{};
+    std::chrono::seconds interval{60};
+
+    for (int n{1}; n < argc; n++)
+    {
+        std::string arg{argv[n]};
+        std::string value{n + 1 < argc ? argv[n + 1] : ""};
+
+        if (arg == "--heuristic" && value == "linear-conflict")
+            heuristic = std::make_shared<Heuristic::LinearConflictHeuristic>();
+        else if (arg == "--heuristic" && value == "linear-conflict-table")
+            heuristic = std::make_shared<Heuristic::LinearConflictTableHeuristic>();
+        else if (arg == "--heuristic" && value == "manhattan")
+            heuristic = std::make_shared<Heuristic::ManhattanDistanceHeuristic>();
+        else if (arg == "--heuristic" && value == "misplaced")
+            heuristic = std::make_shared<Heuristic::MisplacedTilesHeuristic>();
+        else if (arg == "--cr")
+        {
+            options.threshold = Puzzle::Threshold::CONTROLLED;
+            continue;
+        }
+        else if (arg == "--checkpoint" && !value.empty())
+            checkpoint = value;
+        else if (arg == "--interval" && !value.empty() && value.find_first_not_of("0123456789") == std::string::npos)
+            interval = std::chrono::seconds{std::max<unsigned long>(1, std::stoul(value))};
+        else if (arg == "--resume" && !value.empty())
+            resume = value;
+        else
+        {
+            std::cerr << USAGE;
+            return 1;
+        }
+        n++;
+    }
+
+    std::unique_ptr<SolverSession> session{};
+    try
+    {
+        if (!resume.empty())
+        {
+            session = SolverSession::restore(resume, heuristic);
+        }
+        else
+        {
+            Puzzle puzzle{15};
+            std::string line{};
+            if (!std::getline(std::cin, line) || !puzzle.parseTiles(line))
+            {
+                std::cerr << USAGE;
+                return 1;
+            }
+
+            session = std::make_unique<SolverSession>(puzzle, heuristic, options);
+        }
+    }
+    catch (Search::CheckpointException &e)
+    {
+        std::cerr << resume << ": " << e.what() << '\n';
+        return 1;
+    }
+
+    std::signal(SIGINT, interrupt);
+    std::signal(SIGTERM, interrupt);
+
+    session->start();
+
+    auto nextCheckpoint{std::chrono::steady_clock::now() + interval};
+    while (session->getState() == SolverSession::State::RUNNING)
+    {
+        std::this_thread::sleep_for(POLL_INTERVAL);
+
+        try
+        {
+            if (interrupted)
+            {
+                // Finished meanwhile otherwise
+                session->suspend();
+                if (session->getState() != SolverSession::State::SUSPENDED)
+                    break;
+
+                if (!checkpoint.empty())
+                {
+                    session->checkpoint(checkpoint);
+                    std::cerr << "Progress saved to " << checkpoint << '\n';
+                }
+                return 130;
+            }
+
+            if (!checkpoint.empty() && std::chrono::steady_clock::now() >= nextCheckpoint)
+            {
+                session->checkpoint(checkpoint);
+                nextCheckpoint = std::chrono::steady_clock::now() + interval;
+            }
+        }
+        catch (Search::CheckpointException &e)
+        {
+            std::cerr << checkpoint << ": " << e.what() << '\n';
+            return 1;
+        }
+    }
+    session->wait();
+
+    switch (session->getState())
+    {
+    case SolverSession::State::SOLVED:
+        break;
+    case SolverSession::State::UNSOLVABLE:
+        std::cerr << strings::EXCEPT_UNSOLVABLE_PUZZLE << '\n';
+        return 1;
+    default:
+        std::cerr << strings::EXCEPT_MAX_THRESHOLD << '\n';
+        return 1;
+    }
+
+    for (Puzzle::Move move : session->getSolution())
+        std::cout << Puzzle::MOVE_NAMES[move];
+    std::cout << '\n';
+
+    std::chrono::duration<double> elapsed{session->getElapsed()};
+    std::cout << "length " << session->getSolution().size() << ", " << session->getStats().nodes << " nodes, "
+              << std::fixed << std::setprecision(3) << elapsed.count() << "s\n";
+
+    return 0;
+}